@@ -0,0 +1,374 @@
+// container/flat_hash_map.hpp -- FlatHashMap and FlatHashSet are open-addressing hash containers in the style of Swiss tables: all the entries are stored
+// in one flat array, alongside an array of one-byte control codes which can be checked sixteen at a time (with SSE2, where available) while probing. This
+// is far friendlier to the cache than the node-based std::unordered_map, especially for lookups that miss.
+
+// SPDX-FileType: SOURCE
+// SPDX-FileCopyrightText: Copyright 2025 Raine Simmons <gc@gravecat.com>
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "trailmix/internal/hash_combine.hpp"
+#include "trailmix/internal/simd.hpp"
+
+namespace trailmix::internal {
+
+static constexpr int8_t FLAT_CTRL_DELETED = -2;     // Control code for a slot which held an entry that has since been erased.
+static constexpr int8_t FLAT_CTRL_EMPTY = -128;     // Control code for a slot which has never been used.
+static constexpr size_t FLAT_GROUP_WIDTH = 16;      // The number of control codes checked at once while probing.
+
+// Returns a bitmask of which of a group of sixteen control codes are equal to a given value.
+inline uint32_t flat_group_match(const int8_t* ctrl, int8_t value) noexcept
+{
+#ifdef TRAILMIX_SIMD_SSE2
+    return sse2_match_mask(reinterpret_cast<const char*>(ctrl), static_cast<char>(value));
+#else
+    uint32_t mask = 0;
+    for (size_t i = 0; i < FLAT_GROUP_WIDTH; i++)
+        if (ctrl[i] == value) mask |= (1U << i);
+    return mask;
+#endif
+}
+
+// Returns a bitmask of which of a group of sixteen control codes are either empty or deleted, i.e. can have a new entry placed in them.
+inline uint32_t flat_group_match_free(const int8_t* ctrl) noexcept
+{
+#ifdef TRAILMIX_SIMD_SSE2
+    return static_cast<uint32_t>(_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl))));
+#else
+    uint32_t mask = 0;
+    for (size_t i = 0; i < FLAT_GROUP_WIDTH; i++)
+        if (ctrl[i] < 0) mask |= (1U << i);
+    return mask;
+#endif
+}
+
+// The table underneath FlatHashMap and FlatHashSet. Slot is the type stored in the table, and KeyOf extracts the key from a slot.
+template<typename Slot, typename Key, typename KeyOf, typename Hash, typename Eq> class FlatHashTable
+{
+public:
+    // Iterates over all the entries in the table, in no particular order.
+    template<bool Const> class Iterator
+    {
+    public:
+        using difference_type = std::ptrdiff_t;
+        using iterator_category = std::forward_iterator_tag;
+        using pointer = std::conditional_t<Const, const Slot*, Slot*>;
+        using reference = std::conditional_t<Const, const Slot&, Slot&>;
+        using value_type = Slot;
+
+                    Iterator() = default;   // Creates an invalid iterator.
+                    Iterator(const int8_t* ctrl, const int8_t* ctrl_end, pointer slot) : ctrl_(ctrl), ctrl_end_(ctrl_end), slot_(slot) { skip_free(); }
+                    // Converts a non-const iterator to a const one.
+        template<bool C = Const, typename = std::enable_if_t<!C>> operator Iterator<true>() const { return Iterator<true>(ctrl_, ctrl_end_, slot_); }
+        reference   operator*() const { return *slot_; }
+        pointer     operator->() const { return slot_; }
+        Iterator&   operator++() { ctrl_++; slot_++; skip_free(); return *this; }
+        Iterator    operator++(int) { Iterator old = *this; ++(*this); return old; }
+        bool        operator==(const Iterator& other) const { return ctrl_ == other.ctrl_; }
+        bool        operator!=(const Iterator& other) const { return ctrl_ != other.ctrl_; }
+
+    private:
+        // Moves forward past any empty or deleted slots.
+        void        skip_free() { while (ctrl_ < ctrl_end_ && *ctrl_ < 0) { ctrl_++; slot_++; } }
+
+        const int8_t*   ctrl_ = nullptr;    // The control code for the current slot.
+        const int8_t*   ctrl_end_ = nullptr;    // The end of the control codes (not counting the cloned group at the end).
+        pointer         slot_ = nullptr;    // The current slot.
+
+        friend class FlatHashTable;
+    };
+
+    using const_iterator = Iterator<true>;
+    using iterator = Iterator<false>;
+
+                FlatHashTable() = default;  // Creates an empty table; nothing is allocated until the first entry is added.
+                FlatHashTable(const FlatHashTable& other) : eq_(other.eq_), hash_(other.hash_) { copy_from(other); }
+                FlatHashTable(FlatHashTable&& other) noexcept { swap(other); }
+                ~FlatHashTable() { destroy(); }
+    FlatHashTable&  operator=(const FlatHashTable& other) { if (this != &other) { FlatHashTable copy(other); swap(copy); } return *this; }
+    FlatHashTable&  operator=(FlatHashTable&& other) noexcept { if (this != &other) { destroy(); swap(other); } return *this; }
+    iterator        begin() { return iterator(ctrl_, ctrl_ + capacity_, slots_); }
+    const_iterator  begin() const { return const_iterator(ctrl_, ctrl_ + capacity_, slots_); }
+    size_t          capacity() const { return capacity_; }  // Returns the number of slots in the table.
+    void            clear() // Erases all entries from the table, but keeps its memory.
+    {
+        if (!capacity_) return;
+        for (size_t i = 0; i < capacity_; i++)
+            if (ctrl_[i] >= 0) slots_[i].~Slot();
+        std::memset(ctrl_, FLAT_CTRL_EMPTY, capacity_ + FLAT_GROUP_WIDTH - 1);
+        size_ = 0;
+        growth_left_ = max_load(capacity_);
+    }
+    bool            contains(const Key& key) const { return find_index(key) != NOT_FOUND; }    // Checks if a key is in the table.
+    size_t          count(const Key& key) const { return contains(key) ? 1 : 0; }  // Returns 1 if a key is in the table, 0 if not.
+    bool            empty() const { return !size_; }    // Checks if the table is empty.
+    iterator        end() { return iterator(ctrl_ + capacity_, ctrl_ + capacity_, slots_ + capacity_); }
+    const_iterator  end() const { return const_iterator(ctrl_ + capacity_, ctrl_ + capacity_, slots_ + capacity_); }
+    size_t          erase(const Key& key)   // Erases a key from the table, and returns the number of entries erased (0 or 1).
+    {
+        const size_t index = find_index(key);
+        if (index == NOT_FOUND) return 0;
+        erase_index(index);
+        return 1;
+    }
+    iterator        erase(const_iterator pos)   // Erases the entry at a given position, and returns an iterator to the next entry.
+    {
+        const size_t index = static_cast<size_t>(pos.ctrl_ - ctrl_);
+        erase_index(index);
+        return iterator(ctrl_ + index + 1, ctrl_ + capacity_, slots_ + index + 1);
+    }
+    iterator        find(const Key& key)    // Finds a key in the table, or returns end() if it isn't there.
+    {
+        const size_t index = find_index(key);
+        return (index == NOT_FOUND ? end() : iterator(ctrl_ + index, ctrl_ + capacity_, slots_ + index));
+    }
+    const_iterator  find(const Key& key) const  // As above, but returns a const iterator.
+    {
+        const size_t index = find_index(key);
+        return (index == NOT_FOUND ? end() : const_iterator(ctrl_ + index, ctrl_ + capacity_, slots_ + index));
+    }
+    void            reserve(size_t count)   // Makes sure the table can hold a given number of entries without rehashing.
+    {
+        size_t new_capacity = (capacity_ ? capacity_ : FLAT_GROUP_WIDTH);
+        while (max_load(new_capacity) < count) new_capacity *= 2;
+        if (new_capacity > capacity_) rehash(new_capacity);
+    }
+    size_t          size() const { return size_; }  // Returns the number of entries in the table.
+    void            swap(FlatHashTable& other) noexcept // Swaps the contents of two tables.
+    {
+        std::swap(capacity_, other.capacity_);
+        std::swap(ctrl_, other.ctrl_);
+        std::swap(eq_, other.eq_);
+        std::swap(growth_left_, other.growth_left_);
+        std::swap(hash_, other.hash_);
+        std::swap(size_, other.size_);
+        std::swap(slots_, other.slots_);
+    }
+
+    // Adds an entry for a key if it's not already in the table, constructing the slot from the given arguments. Returns an iterator to the entry for the
+    // key, and whether a new entry was added.
+    template<typename... Args> std::pair<iterator, bool> try_emplace_key(const Key& key, Args&&... args)
+    {
+        const size_t hash = hash_key(key);
+        size_t index = find_index(key, hash);
+        if (index != NOT_FOUND) return {iterator(ctrl_ + index, ctrl_ + capacity_, slots_ + index), false};
+
+        if (!growth_left_) grow();
+        index = find_free_index(hash);
+        ::new (static_cast<void*>(slots_ + index)) Slot(std::forward<Args>(args)...);
+        if (ctrl_[index] == FLAT_CTRL_EMPTY) growth_left_--;
+        set_ctrl(index, hash_h2(hash));
+        size_++;
+        return {iterator(ctrl_ + index, ctrl_ + capacity_, slots_ + index), true};
+    }
+
+private:
+    static constexpr size_t NOT_FOUND = SIZE_MAX;   // Returned by find_index() when a key isn't found.
+
+    // Copies the entries from another table, which must have the same hash function, into this empty table.
+    void            copy_from(const FlatHashTable& other)
+    {
+        if (!other.capacity_) return;
+        allocate(other.capacity_);
+        for (size_t i = 0; i < capacity_; i++)
+            if (other.ctrl_[i] >= 0) ::new (static_cast<void*>(slots_ + i)) Slot(other.slots_[i]);
+        std::memcpy(ctrl_, other.ctrl_, capacity_ + FLAT_GROUP_WIDTH - 1);
+        size_ = other.size_;
+        growth_left_ = other.growth_left_;
+    }
+
+    // Allocates memory for a given number of slots, with all the control codes set to empty.
+    void            allocate(size_t new_capacity)
+    {
+        ctrl_ = new int8_t[new_capacity + FLAT_GROUP_WIDTH - 1];
+        std::memset(ctrl_, FLAT_CTRL_EMPTY, new_capacity + FLAT_GROUP_WIDTH - 1);
+        slots_ = std::allocator<Slot>().allocate(new_capacity);
+        capacity_ = new_capacity;
+        growth_left_ = max_load(new_capacity);
+    }
+
+    // Destroys all the entries in the table and frees its memory.
+    void            destroy()
+    {
+        if (!capacity_) return;
+        for (size_t i = 0; i < capacity_; i++)
+            if (ctrl_[i] >= 0) slots_[i].~Slot();
+        std::allocator<Slot>().deallocate(slots_, capacity_);
+        delete[] ctrl_;
+        capacity_ = growth_left_ = size_ = 0;
+        ctrl_ = nullptr;
+        slots_ = nullptr;
+    }
+
+    // Erases the entry in a given slot.
+    void            erase_index(size_t index)
+    {
+        slots_[index].~Slot();
+        set_ctrl(index, FLAT_CTRL_DELETED);
+        size_--;
+    }
+
+    // Finds the first empty or deleted slot along a hash's probe sequence. There must be at least one.
+    size_t          find_free_index(size_t hash) const
+    {
+        const size_t mask = capacity_ - 1;
+        size_t pos = hash_h1(hash) & mask, step = 0;
+        while (true)
+        {
+            const uint32_t free = flat_group_match_free(ctrl_ + pos);
+            if (free) return (pos + lowest_set_bit(free)) & mask;
+            step += FLAT_GROUP_WIDTH;
+            pos = (pos + step) & mask;
+        }
+    }
+
+    // Finds the slot holding a given key, or returns NOT_FOUND.
+    size_t          find_index(const Key& key) const { return capacity_ ? find_index(key, hash_key(key)) : NOT_FOUND; }
+
+    // As above, but with the key's hash already calculated.
+    size_t          find_index(const Key& key, size_t hash) const
+    {
+        if (!capacity_) return NOT_FOUND;
+        const size_t mask = capacity_ - 1;
+        const int8_t h2 = hash_h2(hash);
+        size_t pos = hash_h1(hash) & mask, step = 0;
+        while (true)
+        {
+            const int8_t* group = ctrl_ + pos;
+            for (uint32_t match = flat_group_match(group, h2); match; match &= match - 1)
+            {
+                const size_t index = (pos + lowest_set_bit(match)) & mask;
+                if (eq_(KeyOf()(slots_[index]), key)) return index;
+            }
+            if (flat_group_match(group, FLAT_CTRL_EMPTY)) return NOT_FOUND;
+            step += FLAT_GROUP_WIDTH;
+            pos = (pos + step) & mask;
+        }
+    }
+
+    // Makes room for more entries, either by doubling the table's size, or by rehashing at the same size if enough of the slots are only deleted.
+    void            grow() { rehash(capacity_ && size_ < max_load(capacity_) / 2 ? capacity_ : (capacity_ ? capacity_ * 2 : FLAT_GROUP_WIDTH)); }
+
+    // The upper bits of a hash, used to pick where probing starts.
+    static size_t   hash_h1(size_t hash) { return hash >> 7; }
+
+    // The lower seven bits of a hash, stored in the control codes.
+    static int8_t   hash_h2(size_t hash) { return static_cast<int8_t>(hash & 0x7F); }
+
+    // Hashes a key. The result is mixed again, as many std::hash implementations are just the identity for integers.
+    size_t          hash_key(const Key& key) const { return static_cast<size_t>(hash_mix(static_cast<uint64_t>(hash_(key)))); }
+
+    // The number of entries a table with a given number of slots can hold before it needs to grow (seven-eighths full).
+    static size_t   max_load(size_t slots) { return slots - slots / 8; }
+
+    // Moves all the entries into a newly-allocated table with the given number of slots.
+    void            rehash(size_t new_capacity)
+    {
+        int8_t* const old_ctrl = ctrl_;
+        Slot* const old_slots = slots_;
+        const size_t old_capacity = capacity_;
+        allocate(new_capacity);
+        for (size_t i = 0; i < old_capacity; i++)
+        {
+            if (old_ctrl[i] < 0) continue;
+            const size_t hash = hash_key(KeyOf()(old_slots[i]));
+            const size_t index = find_free_index(hash);
+            ::new (static_cast<void*>(slots_ + index)) Slot(std::move(old_slots[i]));
+            old_slots[i].~Slot();
+            set_ctrl(index, hash_h2(hash));
+        }
+        growth_left_ -= size_;
+        if (old_capacity)
+        {
+            std::allocator<Slot>().deallocate(old_slots, old_capacity);
+            delete[] old_ctrl;
+        }
+    }
+
+    // Sets the control code for a slot, along with its clone at the end of the array (so that groups can be read past the end without wrapping).
+    void            set_ctrl(size_t index, int8_t value)
+    {
+        ctrl_[index] = value;
+        if (index < FLAT_GROUP_WIDTH - 1) ctrl_[capacity_ + index] = value;
+    }
+
+    size_t      capacity_ = 0;      // The number of slots in the table; always zero or a power of two no smaller than a group.
+    int8_t*     ctrl_ = nullptr;    // The control code for each slot, followed by clones of the first group's codes.
+    Eq          eq_;                // Compares keys for equality.
+    size_t      growth_left_ = 0;   // How many more empty slots can be filled before the table needs to grow.
+    Hash        hash_;              // Hashes keys.
+    size_t      size_ = 0;          // The number of entries in the table.
+    Slot*       slots_ = nullptr;   // The slots holding the entries.
+};
+
+// Extracts the key from a FlatHashMap entry.
+struct FlatMapKeyOf
+{
+    template<typename K, typename V> const K& operator()(const std::pair<K, V>& entry) const { return entry.first; }
+};
+
+// Extracts the key from a FlatHashSet entry, which is just the key itself.
+struct FlatSetKeyOf
+{
+    template<typename K> const K& operator()(const K& entry) const { return entry; }
+};
+
+}   // namespace trailmix::internal
+
+namespace trailmix::container {
+
+// A hash map with an interface similar to std::unordered_map. Entries move when the map grows, so iterators, pointers and references to them are
+// invalidated by any insertion. The key of an entry must not be modified through an iterator.
+template<typename K, typename V, typename Hash = std::hash<K>, typename Eq = std::equal_to<K>>
+class FlatHashMap : public internal::FlatHashTable<std::pair<K, V>, K, internal::FlatMapKeyOf, Hash, Eq>
+{
+public:
+    using key_type = K;
+    using mapped_type = V;
+    using value_type = std::pair<K, V>;
+
+    V&          at(const K& key)    // Returns the value for a key, or throws if the key isn't in the map.
+    {
+        auto found = this->find(key);
+        if (found == this->end()) throw std::out_of_range("Key not found in FlatHashMap.");
+        return found->second;
+    }
+    const V&    at(const K& key) const  // As above, but for a const map.
+    {
+        auto found = this->find(key);
+        if (found == this->end()) throw std::out_of_range("Key not found in FlatHashMap.");
+        return found->second;
+    }
+                // Adds a key with a value constructed from the given arguments, if the key is not already in the map.
+    template<typename... Args> auto emplace(const K& key, Args&&... args)
+    { return this->try_emplace_key(key, std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple(std::forward<Args>(args)...)); }
+    auto        insert(const value_type& entry) { return this->try_emplace_key(entry.first, entry); }  // Adds an entry, if its key is not already in the map.
+    auto        insert(value_type&& entry) { const K key = entry.first; return this->try_emplace_key(key, std::move(entry)); }    // As above.
+    V&          operator[](const K& key) { return emplace(key).first->second; } // Returns the value for a key, adding a default value if it's not there.
+};
+
+// A hash set with an interface similar to std::unordered_set. Entries move when the set grows, so iterators, pointers and references to them are
+// invalidated by any insertion.
+template<typename K, typename Hash = std::hash<K>, typename Eq = std::equal_to<K>>
+class FlatHashSet : public internal::FlatHashTable<K, K, internal::FlatSetKeyOf, Hash, Eq>
+{
+public:
+    using key_type = K;
+    using value_type = K;
+
+    auto        insert(const K& key) { return this->try_emplace_key(key, key); }    // Adds a key to the set, if it's not already there.
+};
+
+}   // namespace trailmix::container
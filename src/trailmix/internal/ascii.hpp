@@ -0,0 +1,14 @@
+// internal/ascii.hpp -- Small helpers for working with ASCII text without going through the C locale.
+
+// SPDX-FileType: SOURCE
+// SPDX-FileCopyrightText: Copyright 2025 Raine Simmons <gc@gravecat.com>
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+namespace trailmix::internal {
+
+// Folds ASCII capital letters to lower-case, leaving everything else alone, and returns the result as an unsigned byte.
+constexpr unsigned char ascii_fold(char ch) { return static_cast<unsigned char>(ch >= 'A' && ch <= 'Z' ? ch + 32 : ch); }
+
+}   // namespace trailmix::internal
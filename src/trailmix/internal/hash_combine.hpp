@@ -1,4 +1,4 @@
-// internal/hash_combine.hpp -- Used internally by Vector2, Vector2u and Vector3 to work with std::hash.
+// internal/hash_combine.hpp -- Used internally by Vector2, Vector2u and Vector3 to work with std::hash, and by the flat hash containers.
 
 // SPDX-FileType: SOURCE
 // SPDX-FileCopyrightText: Copyright 2025 Raine Simmons <gc@gravecat.com>
@@ -15,4 +15,19 @@ namespace trailmix::internal {
 inline void hash_combine(std::size_t& seed, std::size_t h) noexcept
 { seed ^= h + 0x9e3779b9 + (seed << 6) + (seed >> 2); }
 
+// Thoroughly mixes the bits of a 64-bit integer (this is the MurmurHash3 finaliser), so that every bit of the input affects every bit of the output. This
+// is a bijection, so distinct inputs always give distinct outputs.
+constexpr uint64_t hash_mix(uint64_t x) noexcept
+{
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+// Packs two 32-bit integers into one 64-bit integer, with no information lost.
+constexpr uint64_t hash_pack(uint32_t a, uint32_t b) noexcept { return (static_cast<uint64_t>(a) << 32) | b; }
+
 }   // namespace trailmix::internal
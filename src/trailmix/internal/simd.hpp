@@ -0,0 +1,89 @@
+// internal/simd.hpp -- Used internally to detect which SIMD instruction sets can be used at compile time, along with a few helpers for working with the
+// results. Code using these must always have a scalar fallback.
+
+// SPDX-FileType: SOURCE
+// SPDX-FileCopyrightText: Copyright 2025 Raine Simmons <gc@gravecat.com>
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <cstdint>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TRAILMIX_SIMD_SSE2
+#include <emmintrin.h>
+#endif
+
+// AVX2 can't be assumed at compile time, but functions can be compiled for it separately, and chosen at runtime with cpu_has_avx2().
+#if defined(TRAILMIX_SIMD_SSE2) && (defined(__GNUC__) || defined(__clang__) || defined(_MSC_VER))
+#define TRAILMIX_SIMD_AVX2_DISPATCH
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#define TRAILMIX_TARGET_AVX2
+#else
+#define TRAILMIX_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace trailmix::internal {
+
+// Checks at runtime whether the CPU (and operating system) support AVX2.
+inline bool cpu_has_avx2() noexcept
+{
+#ifdef TRAILMIX_SIMD_AVX2_DISPATCH
+    static const bool has_avx2 = []() -> bool {
+#if defined(_MSC_VER) && !defined(__clang__)
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] < 7) return false;
+        __cpuid(info, 1);
+        const bool osxsave = (info[2] & (1 << 27)), avx = (info[2] & (1 << 28));
+        if (!osxsave || !avx || (_xgetbv(0) & 6) != 6) return false;
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5));
+#else
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2");
+#endif
+    }();
+    return has_avx2;
+#else
+    return false;
+#endif
+}
+
+// Returns the index of the lowest set bit in a non-zero integer.
+inline int lowest_set_bit(uint32_t mask) noexcept
+{
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return static_cast<int>(index);
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+
+#ifdef TRAILMIX_SIMD_SSE2
+// Flips the case of every byte in a 16-byte block which falls between first and last (inclusive). With 'A' and 'Z' this converts ASCII letters to
+// lower-case, and with 'a' and 'z' to upper-case. Bytes above 127 compare as negative, so they're never changed.
+inline __m128i sse2_flip_case(__m128i block, char first, char last) noexcept
+{
+    const __m128i in_range = _mm_and_si128(_mm_cmpgt_epi8(block, _mm_set1_epi8(static_cast<char>(first - 1))),
+        _mm_cmplt_epi8(block, _mm_set1_epi8(static_cast<char>(last + 1))));
+    return _mm_xor_si128(block, _mm_and_si128(in_range, _mm_set1_epi8(0x20)));
+}
+
+// Returns a 16-bit mask of which bytes in a 16-byte block are equal to a given character.
+inline uint32_t sse2_match_mask(const char* data, char ch) noexcept
+{
+    const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+    return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, _mm_set1_epi8(ch))));
+}
+#endif
+
+}   // namespace trailmix::internal
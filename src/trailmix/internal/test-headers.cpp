@@ -4,7 +4,11 @@
 // SPDX-FileCopyrightText: Copyright 2025 Raine Simmons <gc@gravecat.com>
 // SPDX-License-Identifier: MIT
 
+#include "trailmix/container/flat_hash_map.hpp"
+#include "trailmix/internal/ascii.hpp"
+#include "trailmix/internal/simd.hpp"
 #include "trailmix/math/rect.hpp"
 #include "trailmix/math/vector2.hpp"
 #include "trailmix/math/vector3.hpp"
 #include "trailmix/text/set_string.hpp"
+#include "trailmix/text/string_sink.hpp"
@@ -94,25 +94,16 @@ struct Vector2u
 
 // specialise std::hash
 namespace std {
-using trailmix::internal::hash_combine;
+// Both coordinates are packed into one 64-bit integer and then mixed, rather than combining std::hash<int32_t> (which is just the identity on most
+// standard libraries), so that nearby coordinates don't end up with similar hashes.
 template <> struct hash<trailmix::math::Vector2>
 {
     std::size_t operator()(const trailmix::math::Vector2& v) const noexcept
-    {
-        std::size_t seed = 0;
-        hash_combine(seed, std::hash<int32_t>{}(v.x));
-        hash_combine(seed, std::hash<int32_t>{}(v.y));
-        return seed;
-    }
+    { return static_cast<std::size_t>(trailmix::internal::hash_mix(trailmix::internal::hash_pack(static_cast<uint32_t>(v.x), static_cast<uint32_t>(v.y)))); }
 };
 template <> struct hash<trailmix::math::Vector2u>
 {
     std::size_t operator()(const trailmix::math::Vector2u& v) const noexcept
-    {
-        std::size_t seed = 0;
-        hash_combine(seed, std::hash<uint32_t>{}(v.x));
-        hash_combine(seed, std::hash<uint32_t>{}(v.y));
-        return seed;
-    }
+    { return static_cast<std::size_t>(trailmix::internal::hash_mix(trailmix::internal::hash_pack(v.x, v.y))); }
 };
 }   // namespace std
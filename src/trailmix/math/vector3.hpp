@@ -96,16 +96,15 @@ struct Vector3u
 
 // specialise std::hash
 namespace std {
-using trailmix::internal::hash_combine;
+// As with Vector2, the coordinates are mixed together properly, rather than combining std::hash<int32_t> (which is just the identity on most standard
+// libraries).
 template <> struct hash<trailmix::math::Vector3>
 {
     std::size_t operator()(const trailmix::math::Vector3& v) const noexcept
     {
-        std::size_t seed = 0;
-        hash_combine(seed, std::hash<int32_t>{}(v.x));
-        hash_combine(seed, std::hash<int32_t>{}(v.y));
-        hash_combine(seed, std::hash<int32_t>{}(v.z));
-        return seed;
+        using trailmix::internal::hash_mix;
+        const uint64_t xy = hash_mix(trailmix::internal::hash_pack(static_cast<uint32_t>(v.x), static_cast<uint32_t>(v.y)));
+        return static_cast<std::size_t>(hash_mix(xy ^ static_cast<uint32_t>(v.z)));
     }
 };
 }   // namespace std
@@ -0,0 +1,268 @@
+// text/ansi_render.cpp -- Converts strings with ANSI colour tags (like {G} or {kR}) into actual ANSI/VT escape sequences, either directly or through a frame
+// buffer that only redraws what has changed since the last frame.
+
+// SPDX-FileType: SOURCE
+// SPDX-FileCopyrightText: Copyright 2025 Raine Simmons <gc@gravecat.com>
+// SPDX-License-Identifier: MIT
+
+#include <array>
+#include <charconv>
+
+#include "trailmix/text/ansi_render.hpp"
+#include "trailmix/text/ansi_text.hpp"
+
+using std::string;
+using std::string_view;
+
+namespace trailmix::text::ansi {
+
+namespace {
+
+constexpr uint8_t   NO_COLOUR = 0xFF;   // Used in the colour lookup table for characters that aren't colour letters.
+
+// Builds the lookup table from tag letters to colour numbers.
+constexpr std::array<uint8_t, 256> make_colour_table()
+{
+    std::array<uint8_t, 256> table = {};
+    for (auto& entry : table)
+        entry = NO_COLOUR;
+    constexpr char lower[] = "krgybmcw", upper[] = "KRGYBMCW";
+    for (uint8_t i = 0; i < 8; i++)
+    {
+        table[static_cast<unsigned char>(lower[i])] = i;
+        table[static_cast<unsigned char>(upper[i])] = i + 8;
+    }
+    return table;
+}
+
+constexpr std::array<uint8_t, 256>  COLOUR_TABLE = make_colour_table();   // Converts tag letters into colour numbers (0-7 normal, 8-15 bright).
+
+// Appends a number to a string, such as a colour code or a cursor position.
+void append_code(string& out, unsigned int code)
+{
+    char buffer[10] = {};
+    const auto result = std::to_chars(buffer, buffer + sizeof(buffer), code);
+    out.append(buffer, result.ptr);
+}
+
+// Appends the escape sequence to set the specified text and background colours.
+void append_sgr(string& out, uint8_t fg, uint8_t bg)
+{
+    out += "\x1b[0";
+    if (fg != DEFAULT_COLOUR)
+    {
+        out += ';';
+        append_code(out, (fg < 8 ? 30 + fg : 82 + fg));
+    }
+    if (bg != DEFAULT_COLOUR)
+    {
+        out += ';';
+        append_code(out, (bg < 8 ? 40 + bg : 92 + bg));
+    }
+    out += 'm';
+}
+
+// Converts a single tag into an escape sequence, if it's a valid colour tag.
+bool render_tag(string_view tag, string& out)
+{
+    uint8_t fg, bg;
+    if (!parse_colour_tag(tag, fg, bg)) return false;
+    append_sgr(out, fg, bg);
+    return true;
+}
+
+// Converts the colour tags in a string into escape sequences, appending the result to a string, and returns true if any colours were set. Anything in braces
+// that isn't a colour tag is just text, but there could still be a valid tag after its opening brace, so the search carries on from there.
+bool render_tags(string_view str, string& out)
+{
+    bool coloured = false;
+    size_t pos = 0;
+    while(true)
+    {
+        const size_t tag_open = str.find('{', pos);
+        const size_t tag_closed = (tag_open == string_view::npos ? string_view::npos : str.find('}', tag_open));
+        if (tag_closed == string_view::npos) break;
+        out.append(str, pos, tag_open - pos);
+        if (render_tag(str.substr(tag_open, tag_closed - tag_open + 1), out))
+        {
+            coloured = true;
+            pos = tag_closed + 1;
+        }
+        else
+        {
+            out += '{';
+            pos = tag_open + 1;
+        }
+    }
+    out.append(str, pos);
+    return coloured;
+}
+
+}   // anonymous namespace
+
+// Parses a colour tag (including its braces) into text and background colours. Returns false if this isn't a valid colour tag.
+bool parse_colour_tag(string_view tag, uint8_t& fg, uint8_t& bg)
+{
+    if (tag == "{0}")
+    {
+        fg = bg = DEFAULT_COLOUR;
+        return true;
+    }
+    if (tag.size() == 3)
+    {
+        fg = COLOUR_TABLE[static_cast<unsigned char>(tag[1])];
+        bg = DEFAULT_COLOUR;
+        return (fg != NO_COLOUR);
+    }
+    if (tag.size() == 4)
+    {
+        bg = COLOUR_TABLE[static_cast<unsigned char>(tag[1])];
+        fg = COLOUR_TABLE[static_cast<unsigned char>(tag[2])];
+        return (fg != NO_COLOUR && bg != NO_COLOUR);
+    }
+    return false;
+}
+
+// Converts ANSI colour tags into escape sequences, appending the result to a string.
+void render_ansi(string_view str, string& out)
+{
+    out.reserve(out.size() + str.size() + 16);
+    if (render_tags(str, out)) out += "\x1b[0m";
+}
+
+// As above, but for pre-parsed text. AnsiText treats everything from a { to the next } as a tag, so each one goes through the same rules as above, which
+// gives exactly the same output even when a "tag" turns out to be literal braces with a real colour tag inside.
+void render_ansi(const AnsiText& text, string& out)
+{
+    out.reserve(out.size() + text.str().size() + 16);
+    bool coloured = false;
+    for (const auto& run : text.runs())
+    {
+        if (run.tag && render_tags(text.tag(run.tag), out)) coloured = true;
+        out += text.text(run);
+    }
+    if (coloured) out += "\x1b[0m";
+}
+
+// As above, but returns the result as a new string.
+string render_ansi(string_view str)
+{
+    string output;
+    render_ansi(str, output);
+    return output;
+}
+
+// Creates a new, blank frame buffer of the specified size.
+AnsiRenderer::AnsiRenderer(unsigned int width, unsigned int height) { resize(width, height); }
+
+// Clears the frame being drawn to blank cells.
+void AnsiRenderer::clear() { cells_.assign(cells_.size(), {' ', DEFAULT_COLOUR, DEFAULT_COLOUR}); }
+
+// Renders the frame, and writes it straight to the terminal.
+void AnsiRenderer::flush(std::FILE* stream)
+{
+    const string& output = render();
+    if (output.empty()) return;
+    std::fwrite(output.data(), 1, output.size(), stream);
+    std::fflush(stream);
+}
+
+// Forces the next frame to redraw every cell, for example if something else has written to the terminal.
+void AnsiRenderer::invalidate() { full_redraw_ = true; }
+
+// Prints ANSI-tagged text onto the frame. Anything outside the frame is clipped.
+void AnsiRenderer::print(int x, int y, string_view str)
+{
+    if (y < 0 || y >= static_cast<int>(height_)) return;
+    uint8_t fg = DEFAULT_COLOUR, bg = DEFAULT_COLOUR;
+    Cell* row = cells_.data() + static_cast<size_t>(y) * width_;
+    for (size_t pos = 0; pos < str.size() && x < static_cast<int>(width_); pos++)
+    {
+        if (str[pos] == '{')
+        {
+            const size_t tag_closed = str.find('}', pos);
+            if (tag_closed != string_view::npos)
+            {
+                uint8_t new_fg, new_bg;
+                if (parse_colour_tag(str.substr(pos, tag_closed - pos + 1), new_fg, new_bg))
+                {
+                    fg = new_fg;
+                    bg = new_bg;
+                    pos = tag_closed;
+                    continue;
+                }
+                // Anything in braces that isn't a colour tag is drawn as text.
+            }
+        }
+        if (x >= 0) row[x] = {str[pos], fg, bg};
+        x++;
+    }
+}
+
+// Generates the escape sequences needed to update the terminal to this frame. The string is reused on the next render.
+const string& AnsiRenderer::render()
+{
+    static constexpr int MAX_GAP = 4;   // Gaps of unchanged cells up to this size are just redrawn, rather than moving the cursor past them.
+
+    output_.clear();
+    if (full_redraw_)
+    {
+        output_ += "\x1b[0m\x1b[2J";
+        term_fg_ = term_bg_ = DEFAULT_COLOUR;
+        previous_.assign(cells_.size(), {' ', DEFAULT_COLOUR, DEFAULT_COLOUR});   // The screen has just been cleared, so it's all blank cells now.
+        full_redraw_ = false;
+    }
+
+    for (unsigned int y = 0; y < height_; y++)
+    {
+        const Cell* row = cells_.data() + static_cast<size_t>(y) * width_;
+        const Cell* prev_row = previous_.data() + static_cast<size_t>(y) * width_;
+        int cursor_x = -1;  // The cursor's position on this row, or -1 if it's somewhere else.
+        for (unsigned int x = 0; x < width_; x++)
+        {
+            if (row[x] == prev_row[x]) continue;
+            if (cursor_x != static_cast<int>(x))
+            {
+                // If there's only a small gap since the last changed cell, and it's all in the current colours, it's cheaper to just draw it again.
+                bool redraw_gap = (cursor_x >= 0 && static_cast<int>(x) - cursor_x <= MAX_GAP);
+                for (int gx = cursor_x; redraw_gap && gx < static_cast<int>(x); gx++)
+                    if (row[gx].fg != term_fg_ || row[gx].bg != term_bg_) redraw_gap = false;
+                if (redraw_gap)
+                {
+                    for (int gx = cursor_x; gx < static_cast<int>(x); gx++)
+                        output_ += row[gx].ch;
+                }
+                else
+                {
+                    output_ += "\x1b[";
+                    append_code(output_, y + 1);
+                    output_ += ';';
+                    append_code(output_, x + 1);
+                    output_ += 'H';
+                }
+            }
+            if (row[x].fg != term_fg_ || row[x].bg != term_bg_)
+            {
+                append_sgr(output_, row[x].fg, row[x].bg);
+                term_fg_ = row[x].fg;
+                term_bg_ = row[x].bg;
+            }
+            output_ += row[x].ch;
+            cursor_x = x + 1;
+        }
+    }
+
+    previous_ = cells_;
+    return output_;
+}
+
+// Resizes the frame buffer, clearing it and forcing a full redraw.
+void AnsiRenderer::resize(unsigned int width, unsigned int height)
+{
+    width_ = width;
+    height_ = height;
+    cells_.assign(static_cast<size_t>(width) * height, {' ', DEFAULT_COLOUR, DEFAULT_COLOUR});
+    full_redraw_ = true;
+}
+
+}   // namespace trailmix::text::ansi
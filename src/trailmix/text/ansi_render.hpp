@@ -0,0 +1,67 @@
+// text/ansi_render.hpp -- Converts strings with ANSI colour tags (like {G} or {kR}) into actual ANSI/VT escape sequences, either directly or through a frame
+// buffer that only redraws what has changed since the last frame.
+// A tag with a single letter sets the text colour: k = black, r = red, g = green, y = yellow, b = blue, m = magenta, c = cyan, w = white, with upper-case
+// letters being the bright versions of each colour. It also resets the background to the terminal's default, so every tag fully describes the colours
+// that follow it. A tag with two letters sets the background colour with the first letter, and the text colour with the second; so {kR} is bright red text
+// on a black background. {0} resets both colours to the terminal's defaults.
+
+// SPDX-FileType: SOURCE
+// SPDX-FileCopyrightText: Copyright 2025 Raine Simmons <gc@gravecat.com>
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace trailmix::text::ansi {
+
+class AnsiText;     // Forward declaration, for rendering pre-parsed text.
+
+static constexpr uint8_t    DEFAULT_COLOUR = 16;    // The terminal's default colour, as used by parse_colour_tag().
+
+            // Parses a colour tag (including its braces) into text and background colours. Returns false if this isn't a valid colour tag.
+bool        parse_colour_tag(std::string_view tag, uint8_t& fg, uint8_t& bg);
+void        render_ansi(std::string_view str, std::string& out);    // Converts ANSI colour tags into escape sequences, appending the result to a string.
+void        render_ansi(const AnsiText& text, std::string& out);    // As above, but for pre-parsed text.
+std::string render_ansi(std::string_view str);  // As above, but returns the result as a new string.
+
+// A frame buffer for drawing ANSI-tagged text onto a terminal. Each call to render() only generates escape sequences for the cells that have changed since the
+// previous frame. Each cell holds a single byte, so this is only suitable for ASCII text.
+class AnsiRenderer
+{
+public:
+                AnsiRenderer(unsigned int width, unsigned int height);  // Creates a new, blank frame buffer of the specified size.
+    void        clear();            // Clears the frame being drawn to blank cells.
+    void        flush(std::FILE* stream = stdout);  // Renders the frame, and writes it straight to the terminal.
+    unsigned int    height() const { return height_; }  // Returns the height of the frame buffer.
+    void        invalidate();       // Forces the next frame to redraw every cell, for example if something else has written to the terminal.
+    void        print(int x, int y, std::string_view str);  // Prints ANSI-tagged text onto the frame. Anything outside the frame is clipped.
+    const std::string&  render();   // Generates the escape sequences needed to update the terminal to this frame. The string is reused on the next render.
+    void        resize(unsigned int width, unsigned int height);    // Resizes the frame buffer, clearing it and forcing a full redraw.
+    unsigned int    width() const { return width_; }    // Returns the width of the frame buffer.
+
+private:
+    // A single character cell on the terminal, and its colours.
+    struct Cell
+    {
+        bool    operator==(const Cell& other) const { return (ch == other.ch && fg == other.fg && bg == other.bg); }
+        bool    operator!=(const Cell& other) const { return !(*this == other); }
+
+        char    ch;
+        uint8_t fg, bg;
+    };
+
+    std::vector<Cell>   cells_;     // The frame currently being drawn.
+    bool        full_redraw_;       // Whether the next frame has to redraw every cell.
+    unsigned int    height_;        // The height of the frame buffer.
+    std::string output_;            // The escape sequences generated by the last call to render().
+    std::vector<Cell>   previous_;  // The last frame that was rendered.
+    uint8_t     term_bg_, term_fg_; // The colours the terminal is currently set to.
+    unsigned int    width_;         // The width of the frame buffer.
+};
+
+}   // namespace trailmix::text::ansi
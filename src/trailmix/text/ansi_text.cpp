@@ -0,0 +1,125 @@
+// text/ansi_text.cpp -- The AnsiText class holds a string with ANSI colour tags (like {G} or {kR}) in a pre-parsed form, so that it can be measured, wrapped,
+// flattened and so on as many times as needed without rescanning the tags on every call.
+
+// SPDX-FileType: SOURCE
+// SPDX-FileCopyrightText: Copyright 2025 Raine Simmons <gc@gravecat.com>
+// SPDX-License-Identifier: MIT
+
+#include <stdexcept>
+
+#include "trailmix/text/ansi_text.hpp"
+#include "trailmix/text/ansiutils.hpp"
+
+using std::runtime_error;
+using std::string;
+using std::string_view;
+using std::vector;
+
+namespace trailmix::text::ansi {
+
+// Parses an ANSI-tagged string.
+AnsiText::AnsiText(string str) { assign(std::move(str)); }
+
+// Replaces the contents of this AnsiText with a newly-parsed string.
+void AnsiText::assign(string str)
+{
+    source_ = std::move(str);
+    runs_.clear();
+    tags_.clear();
+    tags_.push_back({0, 0});    // Tag ID 0 means no tag has been seen yet.
+    length_ = 0;
+
+    size_t run_start = 0;
+    uint16_t tag = 0;
+    while(true)
+    {
+        const size_t tag_open = source_.find('{', run_start);
+        const size_t tag_closed = (tag_open == string::npos ? string::npos : source_.find('}', tag_open));
+        if (tag_closed == string::npos) break;
+        if (tag || tag_open > run_start) runs_.push_back({static_cast<uint32_t>(run_start), static_cast<uint32_t>(tag_open - run_start), tag});
+        length_ += tag_open - run_start;
+        tag = tag_id(tag_open, tag_closed - tag_open + 1);
+        run_start = tag_closed + 1;
+    }
+    if (tag || source_.size() > run_start) runs_.push_back({static_cast<uint32_t>(run_start), static_cast<uint32_t>(source_.size() - run_start), tag});
+    length_ += source_.size() - run_start;
+}
+
+// Returns the source string with redundant tags erased, as with flatten_tags().
+string AnsiText::flatten() const
+{
+    string output;
+    output.reserve(source_.size());
+    string_view last_tag;   // The contents of the last tag kept, without its braces; like flatten_tags(), this starts out empty, so {} is always redundant.
+    for (const auto& run : runs_)
+    {
+        if (run.tag)
+        {
+            const string_view this_tag = tag(run.tag);
+            const string_view contents = this_tag.substr(1, this_tag.size() - 2);
+            if (contents != last_tag)
+            {
+                output += this_tag;
+                last_tag = contents;
+            }
+        }
+        output += text(run);
+    }
+    return output;
+}
+
+// Returns the text with all colour tags removed, as with ansi_strip().
+string AnsiText::strip() const
+{
+    string output;
+    output.reserve(length_);
+    for (const auto& run : runs_)
+        output += text(run);
+    return output;
+}
+
+// Returns the full text of a colour tag (e.g. "{kR}"), or an empty view for tag ID 0.
+string_view AnsiText::tag(uint16_t id) const
+{
+    if (!id) return {};
+    if (id >= tags_.size()) throw runtime_error("Invalid AnsiText tag ID: " + std::to_string(id));
+    return string_view(source_).substr(tags_[id].first, tags_[id].second);
+}
+
+// Finds the ID of a tag in the source string, or adds it if it's not yet known.
+uint16_t AnsiText::tag_id(size_t offset, size_t length)
+{
+    const string_view new_tag = string_view(source_).substr(offset, length);
+    for (size_t i = 1; i < tags_.size(); i++)
+        if (tag(static_cast<uint16_t>(i)) == new_tag) return static_cast<uint16_t>(i);
+    if (tags_.size() > UINT16_MAX) throw runtime_error("Too many unique colour tags in AnsiText!");
+    tags_.push_back({static_cast<uint32_t>(offset), static_cast<uint32_t>(length)});
+    return static_cast<uint16_t>(tags_.size() - 1);
+}
+
+// Returns the text of a specified run.
+string_view AnsiText::text(const AnsiRun& run) const { return string_view(source_).substr(run.offset, run.length); }
+
+// Word-wraps the text to a given line length, as with ansi_string_explode().
+vector<string> AnsiText::wrap(unsigned int line_len) const
+{
+    // Check to see if the line of text has the no-split tag at the start, or if it's too short to be worth splitting.
+    if (runs_.size() && runs_[0].tag && tag(runs_[0].tag) == "{_}" && runs_[0].offset == 3) return { source_.substr(3) };
+    if (length_ <= line_len) return { source_ };
+
+    vector<WrappedLine> lines;
+    LineWrapper wrapper(lines, line_len);
+    for (const auto& run : runs_)
+    {
+        if (run.tag) wrapper.tag(string_view(source_.data() + run.offset - tags_[run.tag].second, tags_[run.tag].second));
+        wrapper.text(text(run));
+    }
+    wrapper.finish();
+
+    vector<string> output(lines.size() ? lines.size() : 1);
+    for (size_t i = 0; i < lines.size(); i++)
+        lines[i].assign_to(output[i]);
+    return output;
+}
+
+}   // namespace trailmix::text::ansi
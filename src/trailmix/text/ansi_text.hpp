@@ -0,0 +1,52 @@
+// text/ansi_text.hpp -- The AnsiText class holds a string with ANSI colour tags (like {G} or {kR}) in a pre-parsed form, so that it can be measured, wrapped,
+// flattened and so on as many times as needed without rescanning the tags on every call.
+
+// SPDX-FileType: SOURCE
+// SPDX-FileCopyrightText: Copyright 2025 Raine Simmons <gc@gravecat.com>
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace trailmix::text::ansi {
+
+// A single run of text within an AnsiText, all of which uses the same colour tag.
+struct AnsiRun
+{
+    uint32_t    offset; // Where this run's text begins in the source string.
+    uint32_t    length; // The length of this run's text, in bytes.
+    uint16_t    tag;    // The ID of the colour tag that begins this run, or 0 if no tag has been seen yet.
+};
+
+class AnsiText
+{
+public:
+                AnsiText() = default;       // Creates an empty AnsiText.
+    explicit    AnsiText(std::string str);  // Parses an ANSI-tagged string.
+    void        assign(std::string str);    // Replaces the contents of this AnsiText with a newly-parsed string.
+    bool        empty() const { return source_.empty(); }   // Checks if this AnsiText is empty.
+    std::string flatten() const;            // Returns the source string with redundant tags erased, as with flatten_tags().
+    size_t      length() const { return length_; }  // Returns the length of the text, not counting the colour tags.
+    const std::vector<AnsiRun>& runs() const { return runs_; }  // Returns the runs of text that make up this AnsiText.
+    const std::string&  str() const { return source_; } // Returns the original, unparsed string.
+    std::string strip() const;              // Returns the text with all colour tags removed, as with ansi_strip().
+    std::string_view    tag(uint16_t id) const; // Returns the full text of a colour tag (e.g. "{kR}"), or an empty view for tag ID 0.
+    std::string_view    text(const AnsiRun& run) const; // Returns the text of a specified run.
+    std::vector<std::string>    wrap(unsigned int line_len = 80) const; // Word-wraps the text to a given line length, as with ansi_string_explode().
+
+private:
+    uint16_t    tag_id(size_t offset, size_t length);   // Finds the ID of a tag in the source string, or adds it if it's not yet known.
+
+    size_t                  length_ = 0;    // The length of the text, not counting colour tags.
+    std::vector<AnsiRun>    runs_;          // The runs of text in the source string, in order.
+    std::string             source_;        // The original string, with tags.
+    std::vector<std::pair<uint32_t, uint32_t>>  tags_;  // The offset and length in the source string of each unique tag, indexed by tag ID.
+};
+
+}   // namespace trailmix::text::ansi
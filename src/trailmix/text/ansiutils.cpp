@@ -6,17 +6,14 @@
 // SPDX-License-Identifier: MIT
 
 #include <cmath>
+#include <cstring>
 #include <stdexcept>
 
 #include "trailmix/text/ansiutils.hpp"
-#include "trailmix/text/comparison.hpp"
-#include "trailmix/text/manipulation.hpp"
 
 using std::runtime_error;
 using std::string;
 using std::vector;
-using trailmix::text::comparison::word_count;
-using trailmix::text::manipulation::string_explode;
 
 namespace trailmix::text::ansi {
 
@@ -44,73 +41,31 @@ uint32_t ansi_centre_strvec(vector<string>& vec)
 vector<string> ansi_string_explode(const string& str, unsigned int line_len)
 {
     vector<string> output;
+    ansi_string_explode(str, line_len, output);
+    return output;
+}
 
+// As above, but writes the lines into an existing vector, reusing its strings where possible.
+void ansi_string_explode(const string& str, unsigned int line_len, vector<string>& out)
+{
     // Check to see if the line of text has the no-split tag at the start.
-    if (str.size() >= 3)
+    if (!str.compare(0, 3, "{_}"))
     {
-        if (!str.substr(0, 3).compare("{_}"))
-        {
-            output.push_back(str.substr(3));
-            return output;
-        }
+        out.resize(1);
+        out[0].assign(str, 3);
+        return;
     }
 
     // Check to see if the line is too short to be worth splitting.
     if (ansi_strlen(str) <= line_len)
     {
-        output.push_back(str);
-        return output;
+        out.resize(1);
+        out[0].assign(str);
+        return;
     }
 
-    // Split the string into individual words.
-    vector<string> words = string_explode(str, " ");
-
-    // Keep track of the current line and our position on it.
-    unsigned int current_line = 0, line_pos = 0;
-    string last_colour = "{0}";    // The last colour tag we encountered; ANSI reset code by default.
-
-    // Start with an empty string.
-    output.push_back("");
-
-    for (auto word : words)
-    {
-        unsigned int length = ansi_strlen(word);    // Find the length of the word, without ANSI tags.
-
-        if (length + line_pos >= line_len)  // Is the word too long for the current line?
-        {
-            line_pos = 0; current_line++;   // CR;LF
-            if (last_colour != "{0}") output.push_back(last_colour);    // Start the line with the last colour tag we saw, if any.
-            else output.push_back("");
-        }
-        size_t open_tag = word.find_last_of('{'), close_tag;
-        if (open_tag != string::npos)
-        {
-            // Duplicate the last-used colour tag.
-            close_tag = word.find_last_of('}');
-            if (close_tag != string::npos) last_colour = word.substr(open_tag, (close_tag - open_tag + 1));
-        }
-        if (line_pos != 0)  // NOT the start of a new line?
-        {
-            length++;
-            output.at(current_line) += " ";
-        }
-
-        // Is the word STILL too long to fit over a single line?
-        while (length > line_len)
-        {
-            const string trunc = word.substr(0, line_len);
-            word = word.substr(line_len);
-            output.at(current_line) += trunc;
-            line_pos = 0;
-            current_line++;
-            output.push_back(last_colour);  // Start the line with the last colour tag we saw.
-            length = word.size();   // Adjusts the length for what we have left over.
-        }
-        output.at(current_line) += word;
-        line_pos += length;
-    }
-
-    return output;
+    wrap_lines(str, line_len, out);
+    if (out.empty()) out.emplace_back();
 }
 
 // Strips all ANSI colour tags like {M} from a string.
@@ -127,85 +82,95 @@ string ansi_strip(const string& str)
 }
 
 // Returns the length of a specified string, not counting the ANSI colour tags like {G} or {kR}.
-size_t ansi_strlen(const string &str)
-{ return ansi_strip(str).length(); }
+size_t ansi_strlen(std::string_view str)
+{
+    size_t length = 0, pos = 0;
+    while(true)
+    {
+        const size_t tag_open = str.find('{', pos);
+        const size_t tag_closed = (tag_open == std::string_view::npos ? std::string_view::npos : str.find('}', tag_open));
+        if (tag_closed == std::string_view::npos) return length + str.size() - pos;
+        length += tag_open - pos;
+        pos = tag_closed + 1;
+    }
+}
 
 // Splits an ANSI-tagged string across multiple lines of text.
 vector<string> ansi_vector_split(const string& str, uint32_t line_length)
 {
-    string current_line, last_tag;
-    vector<string> result, words = text::manipulation::string_explode(str, " ");
-    uint32_t current_pos = 0;
-
-    while(words.size())
+    // Unlike ansi_string_explode(), this always leaves the last column free, and lets long words overflow rather than splitting them.
+    vector<WrappedLine> lines;
+    wrap_views(str, line_length ? line_length - 1 : 0, lines, {}, false);
+    vector<string> result(lines.size());
+    for (size_t i = 0; i < lines.size(); i++)
     {
-        string word = words.at(0);
-        words.erase(words.begin());
-
-        // Determine if any ANSI tags are within this word. If so, record the last tag. Then measure the word length.
-        size_t found_open = word.find_last_of('{');
-        size_t found_closed = word.find_first_of('}', found_open);
-        size_t word_len = 0;
-        if (found_open != string::npos && found_closed != string::npos)
-        {
-            last_tag = word.substr(found_open, found_closed - found_open + 1);
-            word_len = ansi_strlen(word);
-        }
-        else word_len = word.size();
-
-        // Decide whether or not we're starting a new line.
-        if (current_pos && (current_pos + word_len >= line_length))
-        {
-            result.push_back(current_line);
-            current_line = last_tag + word;
-            current_pos = word_len + 1;
-        }
-        else
-        {
-            current_line += (current_pos  ? " " : "") + word;
-            current_pos += word_len + 1;
-        }
+        result[i].reserve(lines[i].carry_tag.size() + lines[i].text.size());
+        result[i].append(lines[i].carry_tag).append(lines[i].text);
     }
-    if (current_line.size()) result.push_back(current_line);
     return result;
 }
 
 // Counts all the colour tags in a string.
-size_t count_colour_tags(const string& str)
+size_t count_colour_tags(std::string_view str)
 {
     size_t tags = 0;
-    for (size_t i = 0; i < str.size(); i++)
-        if ((str.at(i) == '{') && ((str.size() > i + 1 && str.at(i + 1) == '}') || (str.size() > i + 2 && str.at(i + 2) == '}'))) tags++;
+    const char* const end = str.data() + str.size();
+    for (const char* ptr = str.data(); ptr < end; ptr++)
+        if (*ptr == '{' && ((end - ptr > 1 && ptr[1] == '}') || (end - ptr > 2 && ptr[2] == '}'))) tags++;
     return tags;
 }
 
-// 'Flattens' ANSI tags, by erasing redundant tags in the string.
-string flatten_tags(const string& str)
+namespace {
+
+// Does the actual work for flatten_tags() and flatten_tags_in_place(). The output can be the same buffer as the input, as it's never longer than the input,
+// and never gets ahead of it. Returns the length of the output.
+size_t flatten_tags_into(const char* in, size_t len, char* out)
 {
-    string output, to_check = str, last_tag;
+    const std::string_view str(in, len);
+    char* const out_start = out;
+    std::string_view last_tag;  // Points into the output, which never gets overwritten once written, unlike the input.
+    size_t pos = 0;
 
     while(true)
     {
-        size_t tag_open = to_check.find_first_of('{');
-        size_t tag_closed = to_check.find_first_of('}', tag_open);
-        if (tag_open == string::npos || tag_closed == string::npos)
+        const size_t tag_open = str.find('{', pos);
+        const size_t tag_closed = (tag_open == std::string_view::npos ? std::string_view::npos : str.find('}', tag_open));
+        if (tag_closed == std::string_view::npos)
         {
-            output += to_check;
+            std::memmove(out, in + pos, len - pos);
+            out += len - pos;
             break;
         }
-        string tag_found = to_check.substr(tag_open + 1, tag_closed - tag_open - 1);
-        if (tag_found.compare(last_tag))
+        if (str.substr(tag_open + 1, tag_closed - tag_open - 1) != last_tag)
+        {
+            std::memmove(out, in + pos, tag_closed + 1 - pos);
+            last_tag = std::string_view(out + (tag_open - pos) + 1, tag_closed - tag_open - 1);
+            out += tag_closed + 1 - pos;
+        }
+        else
         {
-            last_tag = tag_found;
-            output += to_check.substr(0, tag_closed + 1);
+            std::memmove(out, in + pos, tag_open - pos);
+            out += tag_open - pos;
         }
-        else output += to_check.substr(0, tag_open);
-        to_check = to_check.substr(tag_closed + 1);
+        pos = tag_closed + 1;
     }
 
+    return out - out_start;
+}
+
+}   // anonymous namespace
+
+// 'Flattens' ANSI tags, by erasing redundant tags in the string.
+string flatten_tags(std::string_view str)
+{
+    string output(str.size(), '\0');
+    output.resize(flatten_tags_into(str.data(), str.size(), output.data()));
     return output;
 }
 
+// As above, but modifies the string in-place.
+void flatten_tags_in_place(string& str) { str.resize(flatten_tags_into(str.data(), str.size(), str.data())); }
+
 // Generates a bar of the specified type.
 string generate_bar(BarType type, float num, float num_max, int width)
 {
@@ -250,66 +215,159 @@ string rainbow_text(const string& str, const string& colours)
 // Similar to string_explode(), but takes colour tags into account, and wraps to a given line length.
 vector<string> string_explode_colour(const string& str, unsigned int line_len, const string& default_colour)
 {
-    vector<string> output;
-    if (!str.size()) return output;
+    if (!str.size()) return {};
 
     // Check to see if the line is too short to be worth splitting.
-    if (ansi_strlen(str) <= line_len)
+    if (ansi_strlen(str) <= line_len) return { str };
+
+    // Every line starts with the last colour tag we saw, or the default colour if the first line doesn't start with a tag of its own.
+    vector<WrappedLine> lines;
+    wrap_views(str, line_len, lines, default_colour);
+    vector<string> output(lines.size());
+    for (size_t i = 0; i < lines.size(); i++)
     {
-        output.push_back(str);
-        return output;
+        if (!i && lines[i].text.size() && lines[i].text[0] == '{') output[i] = lines[i].text;
+        else
+        {
+            output[i].reserve(lines[i].carry_tag.size() + lines[i].text.size());
+            output[i].append(lines[i].carry_tag).append(lines[i].text);
+        }
     }
+    return output;
+}
 
-    // Split the string into individual words.
-    vector<string> words = string_explode(str, " ");
-
-    // Keep track of the current line and our position on it.
-    unsigned int current_line = 0, line_pos = 0;
-    string last_colour = default_colour;    // The last colour tag we encountered; white by default.
+// Word-wraps an ANSI-tagged string into a vector of strings, reusing the vector's existing strings where possible.
+void wrap_lines(std::string_view str, unsigned int line_len, vector<string>& out, std::string_view default_tag, bool split_long_words)
+{
+    static thread_local vector<WrappedLine> lines;
+    wrap_views(str, line_len, lines, default_tag, split_long_words);
+    out.resize(lines.size());
+    for (size_t i = 0; i < lines.size(); i++)
+        lines[i].assign_to(out[i]);
+}
 
-    // Start with an empty string.
-    output.push_back("");
+// Word-wraps an ANSI-tagged string into views of each line, written into the specified vector (which is cleared first).
+void wrap_views(std::string_view str, unsigned int line_len, vector<WrappedLine>& out, std::string_view default_tag, bool split_long_words)
+{
+    out.clear();
+    LineWrapper wrapper(out, line_len, default_tag, split_long_words);
+    size_t pos = 0;
+    while(true)
+    {
+        const size_t tag_open = str.find('{', pos);
+        const size_t tag_closed = (tag_open == std::string_view::npos ? std::string_view::npos : str.find('}', tag_open));
+        if (tag_closed == std::string_view::npos) break;
+        wrapper.text(str.substr(pos, tag_open - pos));
+        wrapper.tag(str.substr(tag_open, tag_closed - tag_open + 1));
+        pos = tag_closed + 1;
+    }
+    wrapper.text(str.substr(pos));
+    wrapper.finish();
+}
 
-    for (auto word : words)
+// Writes this line into a string, starting with the carried-over colour tag (unless it's the {0} reset tag).
+void WrappedLine::assign_to(string& str) const
+{
+    if (carry_tag == "{0}") str.assign(text);
+    else
     {
-        unsigned int length = word.length();    // Find the length of the word.
+        str.reserve(carry_tag.size() + text.size());
+        str.assign(carry_tag).append(text);
+    }
+}
+
+// Sets up the wrapper. Lines are appended to the specified vector, which must outlive the LineWrapper.
+LineWrapper::LineWrapper(vector<WrappedLine>& out, unsigned int line_len, std::string_view default_tag, bool split_long_words) : active_tag_(default_tag),
+    line_len_(line_len), out_(out), split_long_words_(split_long_words) { }
 
-        const int colour_count = word_count(word, "{"); // Count the colour tags.
-        if (colour_count) length -= (colour_count * 3); // Reduce the length if one or more colour tags are found.
-        if (length + line_pos >= line_len)  // Is the word too long for the current line?
+// Places the current word at the end of the current line.
+void LineWrapper::end_word(const char* end)
+{
+    // Words made up of nothing but colour tags don't take up any space. At the start of a line they're just carried over, otherwise they're kept on the end of
+    // the line only if nothing visible comes after them.
+    if (!word_visible_)
+    {
+        if (line_end_)
         {
-            line_pos = 0; current_line++;   // CR;LF
-            output.push_back(last_colour);  // Start the line with the last colour tag we saw.
+            tail_end_ = end;
+            tail_spaces_ = spaces_;
         }
-        if (colour_count)
+        word_start_ = nullptr;
+        return;
+    }
+    line_visible_ += (line_end_ ? spaces_ : 0) + word_visible_;
+    line_end_ = tail_end_ = end;
+    word_start_ = nullptr;
+    word_visible_ = spaces_ = 0;
+}
+
+// Finishes the last word and line, if any.
+void LineWrapper::finish()
+{
+    if (word_start_) end_word(last_end_);
+    if (line_end_)
+    {
+        const char* end = (line_visible_ + tail_spaces_ <= line_len_ ? tail_end_ : line_end_);
+        out_.push_back({line_carry_, std::string_view(line_start_, end - line_start_)});
+    }
+    // If there was nothing visible at all, just keep the last colour tag.
+    else if (line_start_) out_.push_back({line_carry_, std::string_view(line_start_, active_tag_.data() + active_tag_.size() - line_start_)});
+    line_end_ = tail_end_ = line_start_ = nullptr;
+}
+
+// Starts a new word; if nothing visible has been placed on this line yet, the line begins here too.
+void LineWrapper::start_word(const char* start)
+{
+    word_start_ = start;
+    word_carry_ = active_tag_;
+    if (!line_end_)
+    {
+        line_start_ = start;
+        line_carry_ = active_tag_;
+    }
+}
+
+// Processes a colour tag, including its braces.
+void LineWrapper::tag(std::string_view tag)
+{
+    if (!word_start_) start_word(tag.data());
+    active_tag_ = tag;
+    last_end_ = tag.data() + tag.size();
+}
+
+// Processes a block of text.
+void LineWrapper::text(std::string_view text)
+{
+    for (const char* ptr = text.data(); ptr < text.data() + text.size(); ptr++)
+    {
+        if (*ptr == ' ')
         {
-            // Duplicate the last-used colour tag.
-            const string::size_type flo = word.find_last_of("{");
-            if (flo != string::npos && word.size() >= flo + 3) last_colour = word.substr(flo, 3);
+            if (word_start_) end_word(ptr);
+            spaces_++;
+            continue;
         }
-        if (line_pos != 0)  // NOT the start of a new line?
+        if (!word_start_) start_word(ptr);
+        word_visible_++;
+
+        // If the word no longer fits on a line that already has words on it, move the word to a new line.
+        if (line_end_ && line_visible_ + spaces_ + word_visible_ > line_len_)
         {
-            length++;
-            output.at(current_line) += " ";
+            out_.push_back({line_carry_, std::string_view(line_start_, line_end_ - line_start_)});
+            line_start_ = word_start_;
+            line_carry_ = word_carry_;
+            line_end_ = tail_end_ = nullptr;
+            line_visible_ = spaces_ = 0;
         }
-
-        // Is the word STILL too long to fit over a single line?
-        while (length > line_len)
+        // If the word is on a line of its own and is STILL too long, it has to be split.
+        else if (!line_end_ && split_long_words_ && line_len_ && word_visible_ > line_len_)
         {
-            const string trunc = word.substr(0, line_len);
-            word = word.substr(line_len);
-            output.at(current_line) += trunc;
-            line_pos = 0;
-            current_line++;
-            output.push_back(last_colour);  // Start the line with the last colour tag we saw.
-            length = word.size();   // Adjusts the length for what we have left over.
+            out_.push_back({line_carry_, std::string_view(line_start_, ptr - line_start_)});
+            line_start_ = word_start_ = ptr;
+            line_carry_ = word_carry_ = active_tag_;
+            word_visible_ = 1;
         }
-        output.at(current_line) += word;
-        line_pos += length;
     }
-
-    if (output.size() && output.at(0)[0] != '{') output.at(0) = default_colour + output.at(0);
-    return output;
+    last_end_ = text.data() + text.size();
 }
 
 }   // namespace trailmix::text::amsi
@@ -10,22 +10,68 @@
 #include <cstddef>
 #include <cstdint>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace trailmix::text::ansi {
 
 enum class BarType : uint8_t { PROGRESS };
 
+// A single line of word-wrapped text: the colour tag carried over from the previous line, and a view of this line's text in the source string.
+struct WrappedLine
+{
+    void    assign_to(std::string& str) const;  // Writes this line into a string, starting with the carried-over colour tag (unless it's the {0} reset tag).
+
+    std::string_view    carry_tag, text;
+};
+
+// Word-wraps a stream of colour tags and text in a single pass, writing views of each line into a vector. All the tags and text given to it must be views
+// into the same source string, and given to it in order.
+class LineWrapper
+{
+public:
+                // Sets up the wrapper. Lines are appended to the specified vector, which must outlive the LineWrapper.
+                LineWrapper(std::vector<WrappedLine>& out, unsigned int line_len, std::string_view default_tag = {}, bool split_long_words = true);
+    void        finish();                   // Finishes the last word and line, if any.
+    void        tag(std::string_view tag);  // Processes a colour tag, including its braces.
+    void        text(std::string_view text);    // Processes a block of text.
+
+private:
+    void        end_word(const char* end);  // Places the current word at the end of the current line.
+    void        start_word(const char* start);  // Starts a new word; if nothing visible has been placed on this line yet, the line begins here too.
+
+    std::string_view    active_tag_, line_carry_, word_carry_;  // The most recent colour tag, and the tags that were active at the start of this line and word.
+    const char* last_end_ = nullptr;    // The end of the most recent tag or text processed.
+    const char* line_end_ = nullptr;    // The end of the last visible word placed on this line, or nullptr if the line is empty.
+    unsigned int    line_len_;          // The maximum length of a line, not counting colour tags.
+    const char* line_start_ = nullptr;  // The start of the current line.
+    unsigned int    line_visible_ = 0;  // The length of the current line, not counting colour tags.
+    std::vector<WrappedLine>&   out_;   // The lines of wrapped text.
+    unsigned int    spaces_ = 0;        // The number of spaces since the last word ended.
+    bool        split_long_words_;      // Whether words too long to fit on a line of their own are split across lines, or left to overflow.
+    const char* tail_end_ = nullptr;    // The end of any tag-only words placed after the last visible word on this line.
+    unsigned int    tail_spaces_ = 0;   // The number of spaces between the last visible word on this line and tail_end_.
+    const char* word_start_ = nullptr;  // The start of the current word, or nullptr if we're not in a word.
+    unsigned int    word_visible_ = 0;  // The length of the current word, not counting colour tags.
+};
+
 uint32_t    ansii_centre_strvec(std::vector<std::string>& vec); // Centres all the strings in a vector.
 std::vector<std::string>    ansi_string_explode(const std::string& str, unsigned int line_len = 80); // String split/explode function, handles ANSI colour tags.
+            // As above, but writes the lines into an existing vector, reusing its strings where possible.
+void        ansi_string_explode(const std::string& str, unsigned int line_len, std::vector<std::string>& out);
 std::string ansi_strip(const std::string& str);     // Strips all ANSI colour tags like {M} from a string.
-size_t      ansi_strlen(const std::string& str);    // Returns the length of a specified string, not counting the ANSI colour tags like {G} or {kR}.
+size_t      ansi_strlen(std::string_view str);      // Returns the length of a specified string, not counting the ANSI colour tags like {G} or {kR}.
 std::vector<std::string>    ansi_vector_split(const std::string& str, uint32_t line_length);    // Splits an ANSI-tagged string across multiple lines of text.
-size_t      count_colour_tags(const std::string& str);  // Counts all the colour tags in a string.
-std::string flatten_tags(const std::string& str);   // 'Flattens' ANSI tags, by erasing redundant tags in the string.
+size_t      count_colour_tags(std::string_view str);    // Counts all the colour tags in a string.
+std::string flatten_tags(std::string_view str);     // 'Flattens' ANSI tags, by erasing redundant tags in the string.
+void        flatten_tags_in_place(std::string& str);    // As above, but modifies the string in-place.
 std::string generate_bar(BarType type, float num, float num_max, int width);    // Generates a bar of the specified type.
 std::string rainbow_text(const std::string& str, const std::string& colours);   // Makes pretty rainbow text!
                             // Similar to string_explode(), but takes colour tags into account, and wraps to a given line length.
 std::vector<std::string>    string_explode_colour(const std::string& str, unsigned int line_len, const std::string& default_colour = "{w}");
+            // Word-wraps an ANSI-tagged string into a vector of strings, reusing the vector's existing strings where possible.
+void        wrap_lines(std::string_view str, unsigned int line_len, std::vector<std::string>& out, std::string_view default_tag = {}, bool split_long_words = true);
+            // Word-wraps an ANSI-tagged string into views of each line, written into the specified vector (which is cleared first).
+void        wrap_views(std::string_view str, unsigned int line_len, std::vector<WrappedLine>& out, std::string_view default_tag = {}, bool split_long_words = true);
 
 }   // namespace trailmix::text::ansi
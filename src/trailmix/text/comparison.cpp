@@ -4,12 +4,204 @@
 // SPDX-FileCopyrightText: Copyright 2025 Raine Simmons <gc@gravecat.com>
 // SPDX-License-Identifier: MIT
 
+#include <algorithm>
+#include <cstring>
+
+#include "trailmix/internal/ascii.hpp"
+#include "trailmix/internal/simd.hpp"
 #include "trailmix/text/comparison.hpp"
+#include "trailmix/text/hash.hpp"
 
 using std::string;
+using std::string_view;
+using trailmix::internal::ascii_fold;
 
 namespace trailmix::text::comparison {
 
+namespace {
+
+// Finds the first position at which two strings of at least the given length differ, ignoring the case of ASCII letters, or returns len if they don't.
+size_t first_folded_mismatch(const char* a, const char* b, size_t len)
+{
+    size_t pos = 0;
+#ifdef TRAILMIX_SIMD_SSE2
+    for (; pos + 16 <= len; pos += 16)
+    {
+        const __m128i block_a = internal::sse2_flip_case(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + pos)), 'A', 'Z');
+        const __m128i block_b = internal::sse2_flip_case(_mm_loadu_si128(reinterpret_cast<const __m128i*>(b + pos)), 'A', 'Z');
+        const uint32_t equal = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(block_a, block_b)));
+        if (equal != 0xFFFF) return pos + internal::lowest_set_bit(~equal);
+    }
+#endif
+    for (; pos < len; pos++)
+        if (ascii_fold(a[pos]) != ascii_fold(b[pos])) return pos;
+    return len;
+}
+
+// The scalar versions of the functions below, which also finish off whatever is left over after the vectorised versions are done.
+size_t char_count_scalar(string_view str, char ch, size_t pos)
+{
+    size_t count = 0;
+    for (; pos < str.size(); pos++)
+        if (str[pos] == ch) count++;
+    return count;
+}
+
+bool is_number_scalar(string_view str, size_t pos)
+{
+    for (; pos < str.size(); pos++)
+        if (str[pos] < '0' || str[pos] > '9') return false;
+    return true;
+}
+
+unsigned int word_count_scalar(string_view str, string_view word, size_t pos)
+{
+    unsigned int count = 0;
+    while ((pos = str.find(word, pos)) != string_view::npos)
+    {
+        count++;
+        pos += word.size();
+    }
+    return count;
+}
+
+#ifdef TRAILMIX_SIMD_SSE2
+// Counts a character 16 bytes at a time. Each match subtracts -1 from a per-byte counter, which is summed up before it can overflow.
+size_t char_count_sse2(string_view str, char ch)
+{
+    const __m128i needle = _mm_set1_epi8(ch), zero = _mm_setzero_si128();
+    size_t count = 0, pos = 0;
+    while (pos + 16 <= str.size())
+    {
+        __m128i counters = zero;
+        for (int i = 0; i < 255 && pos + 16 <= str.size(); i++, pos += 16)
+        {
+            const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(str.data() + pos));
+            counters = _mm_sub_epi8(counters, _mm_cmpeq_epi8(block, needle));
+        }
+        const __m128i sums = _mm_sad_epu8(counters, zero);
+        count += static_cast<size_t>(_mm_cvtsi128_si32(sums)) + static_cast<size_t>(_mm_extract_epi16(sums, 4));
+    }
+    return count + char_count_scalar(str, ch, pos);
+}
+
+// Checks for digits 16 bytes at a time; subtracting '0' maps the digits to 0-9, and everything else to something larger (as unsigned bytes).
+bool is_number_sse2(string_view str)
+{
+    const __m128i zero_ch = _mm_set1_epi8('0'), nine = _mm_set1_epi8(9);
+    size_t pos = 0;
+    for (; pos + 16 <= str.size(); pos += 16)
+    {
+        const __m128i block = _mm_sub_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(str.data() + pos)), zero_ch);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(block, nine), nine)) != 0xFFFF) return false;
+    }
+    return is_number_scalar(str, pos);
+}
+
+// Finds candidate positions 16 at a time by matching both the first and last characters of the word, and only then compares the rest of it.
+unsigned int word_count_sse2(string_view str, string_view word)
+{
+    const size_t last = word.size() - 1;
+    const __m128i first_ch = _mm_set1_epi8(word[0]), last_ch = _mm_set1_epi8(word[last]);
+    unsigned int count = 0;
+    size_t pos = 0, next_match = 0;
+    for (; pos + last + 16 <= str.size(); pos += 16)
+    {
+        const __m128i block_first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(str.data() + pos));
+        const __m128i block_last = _mm_loadu_si128(reinterpret_cast<const __m128i*>(str.data() + pos + last));
+        uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(block_first, first_ch), _mm_cmpeq_epi8(block_last, last_ch))));
+        while (mask)
+        {
+            const size_t match = pos + internal::lowest_set_bit(mask);
+            mask &= mask - 1;
+            if (match < next_match || std::memcmp(str.data() + match + 1, word.data() + 1, last - 1)) continue;
+            count++;
+            next_match = match + word.size();
+        }
+    }
+    return count + word_count_scalar(str, word, std::max(pos, next_match));
+}
+#endif
+
+#ifdef TRAILMIX_SIMD_AVX2_DISPATCH
+// As above, but 32 bytes at a time, for CPUs that support AVX2.
+TRAILMIX_TARGET_AVX2 size_t char_count_avx2(string_view str, char ch)
+{
+    const __m256i needle = _mm256_set1_epi8(ch), zero = _mm256_setzero_si256();
+    size_t count = 0, pos = 0;
+    while (pos + 32 <= str.size())
+    {
+        __m256i counters = zero;
+        for (int i = 0; i < 255 && pos + 32 <= str.size(); i++, pos += 32)
+        {
+            const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(str.data() + pos));
+            counters = _mm256_sub_epi8(counters, _mm256_cmpeq_epi8(block, needle));
+        }
+        const __m256i sums256 = _mm256_sad_epu8(counters, zero);
+        const __m128i sums = _mm_add_epi64(_mm256_castsi256_si128(sums256), _mm256_extracti128_si256(sums256, 1));
+        count += static_cast<size_t>(_mm_cvtsi128_si32(sums)) + static_cast<size_t>(_mm_extract_epi16(sums, 4));
+    }
+    return count + char_count_scalar(str, ch, pos);
+}
+
+TRAILMIX_TARGET_AVX2 bool is_number_avx2(string_view str)
+{
+    const __m256i zero_ch = _mm256_set1_epi8('0'), nine = _mm256_set1_epi8(9);
+    size_t pos = 0;
+    for (; pos + 32 <= str.size(); pos += 32)
+    {
+        const __m256i block = _mm256_sub_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(str.data() + pos)), zero_ch);
+        if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_max_epu8(block, nine), nine)) != -1) return false;
+    }
+    return is_number_scalar(str, pos);
+}
+
+TRAILMIX_TARGET_AVX2 unsigned int word_count_avx2(string_view str, string_view word)
+{
+    const size_t last = word.size() - 1;
+    const __m256i first_ch = _mm256_set1_epi8(word[0]), last_ch = _mm256_set1_epi8(word[last]);
+    unsigned int count = 0;
+    size_t pos = 0, next_match = 0;
+    for (; pos + last + 32 <= str.size(); pos += 32)
+    {
+        const __m256i block_first = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(str.data() + pos));
+        const __m256i block_last = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(str.data() + pos + last));
+        uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(block_first, first_ch),
+            _mm256_cmpeq_epi8(block_last, last_ch))));
+        while (mask)
+        {
+            const size_t match = pos + internal::lowest_set_bit(mask);
+            mask &= mask - 1;
+            if (match < next_match || std::memcmp(str.data() + match + 1, word.data() + 1, last - 1)) continue;
+            count++;
+            next_match = match + word.size();
+        }
+    }
+    return count + word_count_scalar(str, word, std::max(pos, next_match));
+}
+#endif
+
+}   // anonymous namespace
+
+// Hashes a key case-insensitively.
+size_t CaseInsensitiveHash::operator()(string_view str) const { return static_cast<size_t>(ihash(str)); }
+
+// Compares two keys case-insensitively.
+bool CaseInsensitiveEqual::operator()(string_view a, string_view b) const { return iequals(a, b); }
+
+// Returns a count of the amount of times a character appears in a string.
+size_t char_count(string_view str, char ch)
+{
+#ifdef TRAILMIX_SIMD_AVX2_DISPATCH
+    if (str.size() >= 32 && internal::cpu_has_avx2()) return char_count_avx2(str, ch);
+#endif
+#ifdef TRAILMIX_SIMD_SSE2
+    return char_count_sse2(str, ch);
+#else
+    return char_count_scalar(str, ch, 0);
+#endif
+}
+
 // Finds a piece of a string between two other strings.
 string find_between(const std::string& source, const std::string& before, const std::string& after)
 {
@@ -20,16 +212,43 @@ string find_between(const std::string& source, const std::string& before, const
     return source.substr(bp + before.size(), ap - bp - before.size());
 }
 
+// Compares two strings while ignoring the case of ASCII letters, returning less than, equal to, or greater than zero, like std::string::compare().
+int icompare(string_view a, string_view b)
+{
+    const size_t len = std::min(a.size(), b.size());
+    const size_t pos = first_folded_mismatch(a.data(), b.data(), len);
+    if (pos < len) return (ascii_fold(a[pos]) < ascii_fold(b[pos]) ? -1 : 1);
+    if (a.size() == b.size()) return 0;
+    return (a.size() < b.size() ? -1 : 1);
+}
+
+// Checks if two strings are equal while ignoring the case of ASCII letters.
+bool iequals(string_view a, string_view b) { return a.size() == b.size() && first_folded_mismatch(a.data(), b.data(), a.size()) == a.size(); }
+
+// Hashes a string while ignoring the case of ASCII letters. The result is the same as text::hash::fnv1a_64() of the string in lower-case.
+uint64_t ihash(string_view str)
+{
+    uint64_t hash = hash::FNV1A_64_OFFSET;
+    for (char ch : str)
+        hash = (hash ^ ascii_fold(ch)) * hash::FNV1A_64_PRIME;
+    return hash;
+}
+
 // Simple way to check if a string is in another string.
-bool instr(const string& input, const string& check) { return (input.find(check, 0) != string::npos); }
+bool instr(string_view input, string_view check) { return (input.find(check) != string_view::npos); }
 
-// Checks if a string is a valid number.
-bool is_number(const string& str)
+// Checks if a string is a valid number (one or more ASCII digits).
+bool is_number(string_view str)
 {
-    if (!str.size()) return false;
-    for (auto ch : str)
-        if (!std::isdigit(ch)) return false;
-    return true;
+    if (str.empty()) return false;
+#ifdef TRAILMIX_SIMD_AVX2_DISPATCH
+    if (str.size() >= 32 && internal::cpu_has_avx2()) return is_number_avx2(str);
+#endif
+#ifdef TRAILMIX_SIMD_SSE2
+    return is_number_sse2(str);
+#else
+    return is_number_scalar(str, 0);
+#endif
 }
 
 // Checks if a character is a vowel.
@@ -39,21 +258,19 @@ bool is_vowel(char ch)
     return (ch == 'a' || ch == 'e' || ch == 'i' || ch == 'o' || ch == 'u');
 }
 
-// Returns a count of the amount of times a string is found in a parent string.
-unsigned int word_count(const string& str, const string& word)
+// Returns a count of the amount of times a string is found in a parent string, without overlaps. An empty search string is never counted.
+unsigned int word_count(string_view str, string_view word)
 {
-    unsigned int count = 0;
-    string::size_type word_pos = 0;
-    while(word_pos != string::npos)
-    {
-        word_pos = str.find(word, word_pos);
-        if (word_pos != string::npos)
-        {
-            count++;
-            word_pos += word.length();
-        }
-    }
-    return count;
+    if (word.empty() || word.size() > str.size()) return 0;
+    if (word.size() == 1) return static_cast<unsigned int>(char_count(str, word[0]));
+#ifdef TRAILMIX_SIMD_AVX2_DISPATCH
+    if (str.size() >= 32 + word.size() && internal::cpu_has_avx2()) return word_count_avx2(str, word);
+#endif
+#ifdef TRAILMIX_SIMD_SSE2
+    return word_count_sse2(str, word);
+#else
+    return word_count_scalar(str, word, 0);
+#endif
 }
 
 }   // namespace trailmix::text::comparison
@@ -6,15 +6,40 @@
 
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
+#include <string_view>
 
 namespace trailmix::text::comparison {
 
+// A hash function for case-insensitive std::unordered_map and std::unordered_set keys, for use along with CaseInsensitiveEqual. Both are transparent, so
+// maps using them can be searched with a std::string_view in C++20.
+struct CaseInsensitiveHash
+{
+    using is_transparent = void;
+    size_t      operator()(std::string_view str) const;
+};
+
+// Compares keys case-insensitively, for use along with CaseInsensitiveHash.
+struct CaseInsensitiveEqual
+{
+    using is_transparent = void;
+    bool        operator()(std::string_view a, std::string_view b) const;
+};
+
+size_t  char_count(std::string_view str, char ch);  // Returns a count of the amount of times a character appears in a string.
             // Finds a piece of a string between two other strings.
 std::string find_between(const std::string& source, const std::string& before, const std::string& after);
-bool    instr(const std::string& input, const std::string& check);  // Simple way to check if a string is in another string.
-bool    is_number(const std::string& str);  // Checks if a string is a valid number.
+            // Compares two strings while ignoring the case of ASCII letters, returning less than, equal to, or greater than zero, like std::string::compare().
+int     icompare(std::string_view a, std::string_view b);
+bool    iequals(std::string_view a, std::string_view b);    // Checks if two strings are equal while ignoring the case of ASCII letters.
+            // Hashes a string while ignoring the case of ASCII letters. The result is the same as text::hash::fnv1a_64() of the string in lower-case.
+uint64_t    ihash(std::string_view str);
+bool    instr(std::string_view input, std::string_view check);  // Simple way to check if a string is in another string.
+bool    is_number(std::string_view str);    // Checks if a string is a valid number (one or more ASCII digits).
 bool    is_vowel(char ch);  // Checks if a character is a vowel.
-unsigned int    word_count(const std::string& str, const std::string& word);    // Returns a count of the amount of times a string is found in a parent string.
+            // Returns a count of the amount of times a string is found in a parent string, without overlaps. An empty search string is never counted.
+unsigned int    word_count(std::string_view str, std::string_view word);
 
 }   // namespace trailmix::text::comparison
@@ -5,8 +5,13 @@
 // SPDX-License-Identifier: MIT
 
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
 #include <ctime>
-#include <iomanip>
 #include <iterator>
 #include <sstream>
 #include <stdexcept>
@@ -16,11 +21,315 @@
 
 using std::runtime_error;
 using std::string;
+using std::string_view;
 using std::to_string;
 using std::vector;
 
 namespace trailmix::text::conversion {
 
+namespace {
+
+static constexpr int FTOS_MAX_PRECISION = 1074; // The most decimal places a double can need; any more would only ever be trailing zeroes.
+
+// Appends a string of digits to an existing string, with commas between each group of three.
+void append_digit_groups(string& out, const char* digits, size_t len)
+{
+    size_t first_group = len % 3;
+    if (!first_group) first_group = 3;
+    out.append(digits, first_group);
+    for (size_t i = first_group; i < len; i += 3)
+    {
+        out += ',';
+        out.append(digits + i, 3);
+    }
+}
+
+std::atomic<bool> memo_enabled(true);   // Whether number_to_text() and intoroman() cache their results; see set_number_text_cache().
+
+// Appends the text for a number from a small per-thread cache of recent results, or builds it (and caches it, if caching is enabled) if it's not there. Each
+// different builder gets its own cache. Only numbers from 0 to 9999 are cached, as these make up the vast majority of calls. The builder appends its
+// result to the string it's given.
+template<typename F> void append_memoised(string& out, int64_t num, F&& build)
+{
+    struct MemoEntry
+    {
+        int64_t key = -1;   // The number this entry holds the result for, or -1 if it's unused.
+        string  text;       // The cached result.
+    };
+    static constexpr size_t MEMO_SIZE = 256;
+    thread_local std::array<MemoEntry, MEMO_SIZE> memo;
+
+    if (num < 0 || num > 9999 || !memo_enabled.load(std::memory_order_relaxed))
+    {
+        build(out);
+        return;
+    }
+    MemoEntry& entry = memo[static_cast<size_t>(num) % MEMO_SIZE];
+    if (entry.key != num)
+    {
+        entry.text.clear();
+        build(entry.text);
+        entry.key = num;
+    }
+    out += entry.text;
+}
+
+// Gets the current local time, along with the milliseconds past the current second. The broken-down time is cached for the current minute, so that
+// localtime() only needs to be called once per minute on each thread.
+void local_time_now(struct tm& result, unsigned int& milliseconds)
+{
+    thread_local time_t minute_start = 0;   // The time at the start of the cached minute, or 0 if nothing has been cached yet.
+    thread_local struct tm minute_time = {};    // The broken-down time at the start of the cached minute.
+
+    const auto now = std::chrono::system_clock::now();
+    const time_t now_time = std::chrono::system_clock::to_time_t(now);
+    milliseconds = static_cast<unsigned int>(std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count() % 1000);
+    if (!minute_start || now_time < minute_start || now_time >= minute_start + 60)
+    {
+#ifdef TRAILMIX_TARGET_WINDOWS
+        localtime_s(&minute_time, &now_time);
+#else
+        localtime_r(&now_time, &minute_time);
+#endif
+        minute_start = now_time - minute_time.tm_sec;
+        minute_time.tm_sec = 0;
+    }
+    result = minute_time;
+    result.tm_sec = static_cast<int>(now_time - minute_start);
+}
+
+// Writes a number into a buffer as a fixed number of digits, returning the position after the last digit.
+char* write_digits(char* buffer, unsigned int num, int digits)
+{
+    for (int i = digits - 1; i >= 0; i--)
+    {
+        buffer[i] = static_cast<char>('0' + num % 10);
+        num /= 10;
+    }
+    return buffer + digits;
+}
+
+// Parses an integer with from_chars(), failing if there's anything left over after the number.
+template<typename T> std::optional<T> parse_whole(string_view str, int base)
+{
+    T result;
+    const auto parsed = std::from_chars(str.data(), str.data() + str.size(), result, base);
+    if (parsed.ec != std::errc() || parsed.ptr != str.data() + str.size()) return std::nullopt;
+    return result;
+}
+
+// Skips any leading whitespace in a string, in the same way as std::stoll() and friends.
+string_view skip_whitespace(string_view str)
+{
+    size_t pos = 0;
+    while (pos < str.size() && (str[pos] == ' ' || (str[pos] >= '\t' && str[pos] <= '\r'))) pos++;
+    return str.substr(pos);
+}
+
+// Appends a number to an existing string, padded with leading zeroes to a minimum length.
+void append_padded(string& out, const char* digits, size_t len, size_t min_len)
+{
+    if (len < min_len) out.append(min_len - len, '0');
+    out.append(digits, len);
+}
+
+}   // anonymous namespace
+
+// Appends a float or double to an existing string, as with ftos().
+void append_ftos(string& out, double num, int precision)
+{
+    if (precision < 0) precision = 6;
+    else if (precision > FTOS_MAX_PRECISION) precision = FTOS_MAX_PRECISION;
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+    char buffer[128];
+    const auto result = std::to_chars(buffer, buffer + sizeof(buffer), num, std::chars_format::fixed, precision);
+    if (result.ec == std::errc())
+    {
+        out.append(buffer, result.ptr);
+        return;
+    }
+    // Very large numbers or precisions won't fit in the buffer, so they can be written into the string directly instead.
+    const size_t old_size = out.size();
+    out.resize(old_size + 320 + static_cast<size_t>(precision));
+    const auto long_result = std::to_chars(out.data() + old_size, out.data() + out.size(), num, std::chars_format::fixed, precision);
+    out.resize(long_result.ptr - out.data());
+#else
+    // Floating-point to_chars() isn't available on every standard library, so snprintf() is the fallback.
+    const int len = std::snprintf(nullptr, 0, "%.*f", precision, num);
+    if (len <= 0) return;
+    const size_t old_size = out.size();
+    out.resize(old_size + static_cast<size_t>(len) + 1);
+    std::snprintf(out.data() + old_size, len + 1, "%.*f", precision, num);
+    out.resize(old_size + len);
+#endif
+}
+
+// Appends Roman numerals to an existing string, as with intoroman().
+void append_intoroman(string& out, unsigned short number)
+{
+    if (number == 0) { out += '0'; return; }
+    if (number > 3999) { out += "MMMM+"; return; }
+    append_memoised(out, number, [number](string& output) mutable {
+        static constexpr unsigned short values[] = { 1000, 900, 500, 400, 100, 90, 50, 40, 10, 9, 5, 4, 1 };
+        static constexpr string_view numerals[] = { "M", "CM", "D", "CD", "C", "XC", "L", "XL", "X", "IX", "V", "IV", "I" };
+        output.reserve(output.size() + 15); // The longest possible result is MMMDCCCLXXXVIII.
+        for (int i = 0; i < 13; i++)
+        {
+            while (number >= values[i])
+            {
+                number -= values[i];
+                output += numerals[i];
+            }
+        }
+    });
+}
+
+// Appends a 'pretty' number to an existing string, as with intostr_pretty().
+void append_intostr_pretty(string& out, int num)
+{
+    if (num < 0) out += '-';
+    append_intostr_pretty_u64(out, num < 0 ? 0 - static_cast<uint64_t>(num) : static_cast<uint64_t>(num));
+}
+
+// Unsigned 64-bit version.
+void append_intostr_pretty_u64(string& out, uint64_t num)
+{
+    char buffer[20] = {};
+    const auto result = std::to_chars(buffer, buffer + sizeof(buffer), num);
+    append_digit_groups(out, buffer, result.ptr - buffer);
+}
+
+// Appends a hex number to an existing string, as with itoh().
+void append_itoh(string& out, uint32_t num, uint8_t min_len)
+{
+    char buffer[8] = {};
+    const auto result = std::to_chars(buffer, buffer + sizeof(buffer), num, 16);
+    append_padded(out, buffer, result.ptr - buffer, min_len);
+}
+
+// Appends a zero-padded number to an existing string, as with itos().
+void append_itos(string& out, uint32_t num, size_t min_len)
+{
+    char buffer[10] = {};
+    const auto result = std::to_chars(buffer, buffer + sizeof(buffer), num);
+    append_padded(out, buffer, result.ptr - buffer, min_len);
+}
+
+// Appends a number written out in words to an existing string, as with number_to_text().
+void append_number_to_text(string& out, int64_t num)
+{
+    if (num == 0) { out += "zero"; return; }
+    else if (num > 999999999999LL) { out += "more than nine hundred and ninety-nine billion"; return; }
+    else if (num < -999999999999LL) { out += "less than minus nine hundred and ninety-nine billion"; return; }
+
+    append_memoised(out, num, [num](string& output) {
+        static constexpr string_view below_twenty[] = { "zero", "one", "two", "three", "four", "five", "six", "seven", "eight", "nine", "ten", "eleven",
+            "twelve", "thirteen", "fourteen", "fifteen", "sixteen", "seventeen", "eighteen", "nineteen" };
+        static constexpr string_view tens[] = { "", "ten", "twenty", "thirty", "forty", "fifty", "sixty", "seventy", "eighty", "ninety" };
+        static constexpr string_view scale[] = { "", " thousand", " million", " billion" };
+
+        // Split the number into groups of three digits, then write them out from the largest group down.
+        const bool negative = (num < 0);
+        uint64_t magnitude = (negative ? 0 - static_cast<uint64_t>(num) : static_cast<uint64_t>(num));
+        int chunks[4] = { 0, 0, 0, 0 };
+        for (int group = 0; group < 4; group++)
+        {
+            chunks[group] = static_cast<int>(magnitude % 1000);
+            magnitude /= 1000;
+        }
+
+        output.reserve(output.size() + 128);
+        if (negative) output += "minus ";
+        bool first = true;
+        for (int group = 3; group >= 0; group--)
+        {
+            int chunk = chunks[group];
+            if (!chunk) continue;
+            if (!first) output += ", ";
+            first = false;
+            if (chunk >= 100)
+            {
+                output += below_twenty[chunk / 100];
+                output += " hundred";
+                chunk %= 100;
+                if (chunk) output += " and ";
+            }
+            if (chunk >= 20)
+            {
+                output += tens[chunk / 10];
+                if (chunk % 10)
+                {
+                    output += '-';
+                    output += below_twenty[chunk % 10];
+                }
+            }
+            else if (chunk) output += below_twenty[chunk];
+            output += scale[group];
+        }
+    });
+}
+
+// Appends a timestamp to an existing string, in the specified format.
+void append_timestamp(string& out, TimestampFormat format)
+{
+    struct tm now;
+    unsigned int milliseconds;
+    local_time_now(now, milliseconds);
+
+    char buffer[32];
+    char* pos = buffer;
+    const unsigned int month = now.tm_mon + 1, day = now.tm_mday, hour = now.tm_hour, minute = now.tm_min, second = now.tm_sec;
+    switch(format)
+    {
+        case TimestampFormat::COMPACT: case TimestampFormat::PRETTY:
+        {
+            // The year isn't padded, for compatibility with older timestamps.
+            char year[12];
+            const auto year_end = std::to_chars(year, year + sizeof(year), now.tm_year - 100).ptr;
+            if (format == TimestampFormat::COMPACT)
+            {
+                pos = std::copy(year, year_end, pos);
+                pos = write_digits(pos, month, 2);
+                pos = write_digits(pos, day, 2);
+                pos = write_digits(pos, hour, 2);
+                pos = write_digits(pos, minute, 2);
+            }
+            else
+            {
+                pos = write_digits(pos, day, 2);
+                *pos++ = '/';
+                pos = write_digits(pos, month, 2);
+                *pos++ = '/';
+                pos = std::copy(year, year_end, pos);
+                *pos++ = ' ';
+                pos = write_digits(pos, hour, 2);
+                *pos++ = ':';
+                pos = write_digits(pos, minute, 2);
+            }
+            break;
+        }
+        case TimestampFormat::ISO8601: case TimestampFormat::ISO8601_MS:
+            pos = write_digits(pos, static_cast<unsigned int>(now.tm_year + 1900), 4);
+            *pos++ = '-';
+            pos = write_digits(pos, month, 2);
+            *pos++ = '-';
+            pos = write_digits(pos, day, 2);
+            *pos++ = 'T';
+            pos = write_digits(pos, hour, 2);
+            *pos++ = ':';
+            pos = write_digits(pos, minute, 2);
+            *pos++ = ':';
+            pos = write_digits(pos, second, 2);
+            if (format == TimestampFormat::ISO8601_MS)
+            {
+                *pos++ = '.';
+                pos = write_digits(pos, milliseconds, 3);
+            }
+            break;
+    }
+    out.append(buffer, pos);
+}
+
 // Converts a bool to a string ("true" or "false").
 string bool_to_str(bool b) { return (b ? "true" : "false"); }
 
@@ -48,19 +357,29 @@ string collapse_vector(vector<int> vec)
 // Converts a float or double to a string.
 string ftos(double num, int precision)
 {
-    std::stringstream ss;
-    ss << std::fixed << std::setprecision(precision) << num;
-    return ss.str();
+    string result;
+    append_ftos(result, num, precision);
+    return result;
 }
 
 // Converts a hex string into an integer.
-uint32_t htoi(const string& hex_str)
+uint32_t htoi(string_view hex_str)
 {
-	std::stringstream ss;
-	ss << std::hex << hex_str;
-	uint32_t result;
-	ss >> result;
-	return result;
+    // This keeps the same behaviour as reading with std::hex from a stream: leading whitespace, a sign and a 0x prefix are all allowed, anything after the
+    // number is ignored, invalid strings return 0, and out-of-range values return UINT32_MAX.
+    hex_str = skip_whitespace(hex_str);
+    bool negative = false;
+    if (hex_str.size() && (hex_str[0] == '-' || hex_str[0] == '+'))
+    {
+        negative = (hex_str[0] == '-');
+        hex_str.remove_prefix(1);
+    }
+    if (hex_str.size() > 2 && hex_str[0] == '0' && (hex_str[1] == 'x' || hex_str[1] == 'X')) hex_str.remove_prefix(2);
+    uint32_t result = 0;
+    const auto parsed = std::from_chars(hex_str.data(), hex_str.data() + hex_str.size(), result, 16);
+    if (parsed.ec == std::errc::result_out_of_range) return UINT32_MAX;
+    if (parsed.ec != std::errc()) return 0;
+    return negative ? 0 - result : result;
 }
 
 // Converts an int into a k-style string; for example 10000 becomes 10k.
@@ -131,53 +450,16 @@ string intostr_k(uint64_t num, unsigned int precision)
 // Returns a 'pretty' version of a number in string format, such as "12,345".
 string intostr_pretty(int num)
 {
-    bool negative = false;
-    if (num < 0)
-    {
-        negative = true;
-        num = 0 - num;
-    }
-    string str = std::to_string(num), output;
-
-    // If the number is 3 or less characters long, there's no need for any processing.
-    if (str.length() <= 3) return((negative ? "-" : "") + str);
-
-    do
-    {
-        // Cut the string up, and insert commas where appropriate.
-        output = str.substr(str.length() - 3, 3) + "," + output;
-    str = str.substr(0, str.length() - 3);
-    } while (str.length() > 3);
-
-    // Combine the results.
-    string result = str + "," + output;
-
-    // Remove the trailing comma.
-    result = result.substr(0, result.length() - 1);
-
-    return((negative ? "-" : "") + result);
+    string result;
+    append_intostr_pretty(result, num);
+    return result;
 }
 
 // Unsigned 64-bit version.
 string intostr_pretty_u64(uint64_t num)
 {
-    string str = to_string(num), output;
-
-    // If the number is 3 or less characters long, there's no need for any processing.
-    if (str.length() <= 3) return str;
-
-    do
-    {
-        // Cut the string up, and insert commas where appropriate.
-        output = str.substr(str.length() - 3, 3) + "," + output;
-        str = str.substr(0, str.length() - 3);
-    } while(str.length() > 3);
-
-    // Combine the results.
-    std::string result = str + "," + output;
-
-    // Remove the trailing comma.
-    result = result.substr(0, result.length() - 1);
+    string result;
+    append_intostr_pretty_u64(result, num);
     return result;
 }
 
@@ -191,104 +473,89 @@ string intostr_sign(int num)
 // Converts a number into Roman numerals.
 string intoroman(unsigned short number)
 {
-    if (number == 0) return "0";
-    if (number > 3999) return "MMMM+";
-    const int values[] = { 1000, 900, 500, 400, 100, 90, 50, 40, 10, 9, 5, 4, 1 };
-    const string numerals[] = { "M", "CM", "D", "CD", "C", "XC", "L", "XL", "X", "IX", "V", "IV", "I" };
-    string output = "";
-
-    for (int i = 0; i < 13; i++)
-    {
-        while (number >= values[i])
-        {
-            number -= values[i];
-            output += numerals[i];
-        }
-    }
+    string output;
+    append_intoroman(output, number);
     return output;
 }
 
 // Converts an integer into a hex string.
 string itoh(uint32_t num, uint8_t min_len)
 {
-    std::stringstream ss;
-    ss << std::hex << num;
-    string hex = ss.str();
-    while (min_len && hex.size() < min_len) hex = "0" + hex;
-    return hex;
+    string result;
+    append_itoh(result, num, min_len);
+    return result;
 }
 
 // Converts an integer to a string, but optionally pads it to a minimum length with leading zeroes.
 string itos(uint32_t num, size_t min_len)
 {
-    string result = to_string(num);
-    while (result.size() < min_len) result = "0" + result;
+    string result;
+    append_itos(result, num, min_len);
     return result;
 }
 
 // Converts a number (e.g. 123) into a string (e.g. "one hundred and twenty-three").
 string number_to_text(int64_t num)
 {
-    bool negative = false;
-    if (num == 0) return "zero";
-    else if (num > 999999999999LL) return "more than nine hundred and ninety-nine billion";
-    else if (num < -999999999999LL) return "less than minus nine hundred and ninety-nine billion";
-    else if (num < 0)
-    {
-        negative = true;
-        num = -num;
-    }
-
-    const string below_twenty[] = { "zero", "one", "two", "three", "four", "five", "six", "seven", "eight", "nine", "ten", "eleven", "twelve", "thirteen",
-    "fourteen", "fifteen", "sixteen", "seventeen", "eighteen", "nineteen" };
-    const string tens[] = { "", "ten", "twenty", "thirty", "forty", "fifty", "sixty", "seventy", "eighty", "ninety" };
-    const string scale[] = { "", " thousand", " million", " billion" };
+    string output;
+    append_number_to_text(output, num);
+    return output;
+}
 
-    auto thousand_chunk = [&below_twenty, &tens](int num) -> string {
-        string result;
-        if (num >= 100)
-        {
-            result = below_twenty[num / 100] + " hundred";
-            num %= 100;
-            if (num) result += " and ";
-        }
-        if (num >= 20)
-        {
-            result += tens[num / 10];
-            if (num % 10) result += "-" + below_twenty[num % 10];
-        }
-        else if (num > 0 || result.empty()) result += below_twenty[num];
-        return result;
-    };
+// Parses a floating-point number, or returns std::nullopt if the whole string isn't a valid number.
+std::optional<double> parse_float(string_view str)
+{
+    if (str.empty()) return std::nullopt;
+    double result = 0;
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+    const auto parsed = std::from_chars(str.data(), str.data() + str.size(), result);
+    if (parsed.ec != std::errc() || parsed.ptr != str.data() + str.size()) return std::nullopt;
+#else
+    // Floating-point from_chars() isn't available on every standard library, so strtod() is the fallback. It needs a null-terminated string, and it
+    // accepts a few things from_chars() doesn't, so those are ruled out first.
+    if (str[0] == '+' || str[0] == ' ' || (str[0] >= '\t' && str[0] <= '\r')) return std::nullopt;
+    const string terminated(str);
+    char* end = nullptr;
+    result = std::strtod(terminated.c_str(), &end);
+    if (end != terminated.c_str() + terminated.size()) return std::nullopt;
+#endif
+    return result;
+}
 
-    string output;
-    int group = 0;
-    while(num > 0 && group < 4)
-    {
-        int chunk = num % 1000;
-        num /= 1000;
-        if (chunk)
-        {
-            string result = thousand_chunk(chunk) + scale[group];
-            output = result + (output.empty() ? "" : (group > 0 ? ", " : " ") + output);
-        }
-        group++;
-    }
-    return (negative ? "minus " : "") + output;
+// Parses a hex number, with or without a leading 0x, or returns std::nullopt if the whole string isn't valid.
+std::optional<uint32_t> parse_hex(string_view str)
+{
+    if (str.size() > 2 && str[0] == '0' && (str[1] == 'x' || str[1] == 'X')) str.remove_prefix(2);
+    return parse_whole<uint32_t>(str, 16);
 }
 
-// Converts an integer to a string; handles out-of-range values gracefully.
-int32_t stoi(const string& str)
+// Parses a signed integer, or returns std::nullopt if the whole string isn't a valid number.
+std::optional<int64_t> parse_int(string_view str) { return parse_whole<int64_t>(str, 10); }
+
+// Parses an unsigned integer, or returns std::nullopt if the whole string isn't a valid number.
+std::optional<uint64_t> parse_uint(string_view str) { return parse_whole<uint64_t>(str, 10); }
+
+// Turns the per-thread caches used by number_to_text() and intoroman() on or off. They're on by default.
+void set_number_text_cache(bool enabled) { memo_enabled.store(enabled, std::memory_order_relaxed); }
+
+// Converts a string to an integer; returns INT32_MAX if the string isn't a valid number.
+int32_t stoi(string_view str)
 {
-    try { return (std::stoll(str)); }
-    catch(const std::exception&) { return INT32_MAX; }
+    // As with std::stoll(), leading whitespace and a plus sign are allowed, and anything after the number is ignored.
+    str = skip_whitespace(str);
+    if (str.size() > 1 && str[0] == '+' && str[1] != '-') str.remove_prefix(1);
+    int64_t result = 0;
+    const auto parsed = std::from_chars(str.data(), str.data() + str.size(), result);
+    if (parsed.ec != std::errc()) return INT32_MAX;
+    return static_cast<int32_t>(result);
 }
 
 // Converts a std::string vector into a int vector.
 vector<int> stoi_vec(const vector<string>& vec)
 {
-    std::vector<int> output;
-    for (auto str : vec)
+    vector<int> output;
+    output.reserve(vec.size());
+    for (const auto& str : vec)
         output.push_back(conversion::stoi(str));
     return output;
 }
@@ -305,25 +572,15 @@ bool str_to_bool(const string& str)
     }
 }
 
-// Returns a timestamp in the format of: 1802152346
-string timestamp(bool pretty)
-{
-    time_t ltime = std::time(nullptr);
-    struct tm result;
-#ifdef TRAILMIX_TARGET_WINDOWS
-    localtime_s(&result, &ltime);
-#else
-    localtime_r(&ltime, &result);
-#endif
+// Returns a timestamp, either compact or pretty.
+string timestamp(bool pretty) { return timestamp(pretty ? TimestampFormat::PRETTY : TimestampFormat::COMPACT); }
 
-    string year   = to_string(result.tm_year - 100);
-    string month  = to_string(result.tm_mon + 1);
-    string day    = to_string(result.tm_mday);
-    string hour   = to_string(result.tm_hour);
-    string minute = to_string(result.tm_min);
-    auto pad = [](string& s){ if (s.size() == 1) s = "0" + s; };
-    pad(month); pad(day); pad(hour); pad(minute);
-    return pretty ? day + "/" + month + "/" + year + " " + hour + ":" + minute : year + month + day + hour + minute;
+// Returns a timestamp in the specified format.
+string timestamp(TimestampFormat format)
+{
+    string result;
+    append_timestamp(result, format);
+    return result;
 }
 
 // Returns a time string as a rough description ("a few seconds", "a moment", "a few minutes").
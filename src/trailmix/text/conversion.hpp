@@ -7,16 +7,28 @@
 #pragma once
 
 #include <cstdint>
+#include <optional>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace trailmix::text::conversion {
 
+enum class TimestampFormat : uint8_t { COMPACT, PRETTY, ISO8601, ISO8601_MS };  // 2510191403, 19/10/25 14:03, 2025-10-19T14:03:27, 2025-10-19T14:03:27.123
+
+void            append_ftos(std::string& out, double num, int precision = 1);   // Appends a float or double to an existing string, as with ftos().
+void            append_intoroman(std::string& out, unsigned short number);  // Appends Roman numerals to an existing string, as with intoroman().
+void            append_intostr_pretty(std::string& out, int num);   // Appends a 'pretty' number to an existing string, as with intostr_pretty().
+void            append_intostr_pretty_u64(std::string& out, uint64_t num);  // Unsigned 64-bit version.
+void            append_itoh(std::string& out, uint32_t num, uint8_t min_len);   // Appends a hex number to an existing string, as with itoh().
+void            append_itos(std::string& out, uint32_t num, size_t min_len);    // Appends a zero-padded number to an existing string, as with itos().
+void            append_number_to_text(std::string& out, int64_t num);   // Appends a number written out in words to an existing string, as with number_to_text().
+void            append_timestamp(std::string& out, TimestampFormat format); // Appends a timestamp to an existing string, in the specified format.
 std::string     bool_to_str(bool b);                    // Converts a bool to a string ("true" or "false").
 std::string     collapse_vector(std::vector<std::string> vec);  // Simple function to collapse a string vector into words.
 std::string     collapse_vector(std::vector<int> vec);  // As above, but for an integer vector.
-std::string     ftos(double num, int precision = 1);    // Converts a float or double to a string.
-uint32_t        htoi(const std::string& hex_str);       // Converts a hex string into an integer.
+std::string     ftos(double num, int precision = 1);    // Converts a float or double to a string. Precision is capped at 1074 decimal places.
+uint32_t        htoi(std::string_view hex_str);         // Converts a hex string into an integer.
 std::string     intoroman(unsigned short number);       // Converts a number into Roman numerals.
 std::string     intostr_k(uint64_t num, unsigned int precision = 0);    // Converts an int into a k-style string; for example 10000 becomes 10k.
 std::string     intostr_pretty(int num);                // Returns a 'pretty' version of a number in string format, such as "12,345".
@@ -25,10 +37,16 @@ std::string     intostr_sign(int num);                  // Converts a nummber (l
 std::string     itoh(uint32_t num, uint8_t min_len);    // Converts an integer into a hex string.
 std::string     itos(uint32_t num, size_t min_len);     // Converts an integer to a string, but optionally pads it to a minimum length with leading zeroes.
 std::string     number_to_text(int64_t num);            // Converts a number (e.g. 123) into a string (e.g. "one hundred and twenty-three").
-int32_t         stoi(const std::string& str);           // Converts an integer to a string; handles out-of-range values gracefully.
+std::optional<double>   parse_float(std::string_view str);  // Parses a floating-point number, or returns std::nullopt if the whole string isn't a valid number.
+std::optional<uint32_t> parse_hex(std::string_view str);    // Parses a hex number, with or without a leading 0x, or returns std::nullopt if the whole string isn't valid.
+std::optional<int64_t>  parse_int(std::string_view str);    // Parses a signed integer, or returns std::nullopt if the whole string isn't a valid number.
+std::optional<uint64_t> parse_uint(std::string_view str);   // Parses an unsigned integer, or returns std::nullopt if the whole string isn't a valid number.
+void            set_number_text_cache(bool enabled);    // Turns the per-thread caches used by number_to_text() and intoroman() on or off. They're on by default.
+int32_t         stoi(std::string_view str);             // Converts a string to an integer; returns INT32_MAX if the string isn't a valid number.
 std::vector<int>    stoi_vec(const std::vector<std::string>& vec);  // Converts a std::string vector into an int vector.
 bool            str_to_bool(const std::string& str);    // Converts a string to a bool.
 std::string     timestamp(bool pretty);                 // Returns a timestamp, either compact or pretty.
+std::string     timestamp(TimestampFormat format);      // Returns a timestamp in the specified format.
 std::string     time_string_rough(float seconds);       // Returns a time string as a rough description ("a few seconds", "a moment", "a few minutes").
 std::wstring    to_wstring(const std::string& str);     // Converts a string to a wstring.
 
@@ -5,97 +5,138 @@
 // SPDX-License-Identifier: MIT
 
 #include <algorithm>
-#include <cmath>
-#include <regex>
+#include <cstring>
 
+#include "trailmix/internal/simd.hpp"
 #include "trailmix/text/ansiutils.hpp"
 #include "trailmix/text/formatting.hpp"
 
 using std::string;
 using std::to_string;
 using std::vector;
+using trailmix::text::StringSink;
 using trailmix::text::ansi::ansi_strlen;
 
 namespace trailmix::text::formatting {
 
-// Capitalizes the first letter of a string.
+// Capitalizes the first letter of a string, if it's an ASCII letter.
 string capitalize_first_letter(string str)
 {
-    if (!str.empty()) str[0] = std::toupper(str[0]);
+    capitalize_first_letter_in_place(str);
     return str;
 }
 
+// As above, but modifies the string in-place.
+void capitalize_first_letter_in_place(string& str)
+{
+    if (!str.empty() && str[0] >= 'a' && str[0] <= 'z') str[0] -= 32;
+}
+
 // Pads a string to be centred to a given width.
 string centre_pad(const string& str, unsigned int width)
 {
-    if (width <= str.size()) return str;
-    unsigned int padding = width - str.size();
-    return string(padding / 2, ' ') + str + string(padding - (padding / 2), ' ');
+    string output;
+    centre_pad(output, str, width);
+    return output;
 }
 
-// Centres all the strings in a vector.
-uint32_t centre_strvec(vector<string>& vec)
+// As above, but appends the result to a string or buffer.
+void centre_pad(StringSink out, std::string_view str, unsigned int width)
 {
-    uint32_t longest = 0;
-    for (auto line : vec)
+    if (width <= str.size())
     {
-        unsigned int len = line.size();
-        if (len > longest) longest = len;
+        out += str;
+        return;
     }
-    for (unsigned int i = 0; i < vec.size(); i++)
+    const size_t padding = width - str.size();
+    out.reserve(width);
+    out.append(padding / 2, ' ').append(str).append(padding - (padding / 2), ' ');
+}
+
+// Centres all the strings in a vector.
+uint32_t centre_strvec(vector<string>& vec)
+{
+    size_t longest = 0;
+    for (const auto& line : vec)
+        longest = std::max(longest, line.size());
+    for (auto& line : vec)
     {
-        int to_add = longest - vec.at(i).size();
+        const size_t to_add = longest - line.size();
         if (!to_add) continue;
-        int add_front = to_add / 2;
-        int add_back = to_add - add_front;
-        vec.at(i) = string(add_front, ' ') + vec.at(i) + string(add_back, ' ');
+        const size_t add_front = to_add / 2;
+        line.reserve(longest);
+        line.insert(0, add_front, ' ');
+        line.append(to_add - add_front, ' ');
     }
-    return longest;
+    return static_cast<uint32_t>(longest);
 }
 
 // Converts a vector to a comma-separated list.
-string comma_list(vector<string> vec, uint8_t mode)
+string comma_list(const vector<string>& vec, uint8_t mode)
 {
-    string plus = ", ";
+    string output;
+    comma_list(output, vec, mode);
+    return output;
+}
+
+// As above, but appends the result to a string or buffer.
+void comma_list(StringSink out, const vector<string>& vec, uint8_t mode)
+{
+    std::string_view plus = ", ";
     if (mode == CL_MODE_USE_AND) plus = " and ";
     else if (mode == CL_MODE_USE_OR) plus = " or ";
-    else if (vec.size() == 2) return vec.at(0) + plus + vec.at(1);
 
-    string str;
-    for (unsigned int i = 0; i < vec.size(); i++)
+    size_t total = 0;
+    for (const auto& entry : vec)
+        total += entry.size() + 2;
+    out.reserve(total + plus.size());
+    for (size_t i = 0; i < vec.size(); i++)
     {
-        str += vec.at(i);
-        if (i < vec.size() - 1)
-        {
-            if (i == vec.size() - 2) str += plus;
-            else str += ", ";
-        }
+        out += vec[i];
+        if (i + 2 < vec.size()) out += ", ";
+        else if (i + 2 == vec.size()) out += plus;
     }
-    return str;
 }
 
 // Pads a string to a given length.
 string pad_string(const string& str, unsigned int min_len, bool ansi)
 {
-    string output = str;
-    uint32_t len = (ansi ? ansi_strlen(str) : str.size());
-    if (len < min_len) output += string(min_len - len, ' ');
+    string output;
+    pad_string(output, str, min_len, ansi);
     return output;
 }
 
+// As above, but appends the result to a string or buffer.
+void pad_string(StringSink out, std::string_view str, unsigned int min_len, bool ansi)
+{
+    const size_t len = (ansi ? ansi_strlen(str) : str.size());
+    out.reserve(str.size() + (len < min_len ? min_len - len : 0));
+    out += str;
+    if (len < min_len) out.append(min_len - len, ' ');
+}
+
 // As above, but centers the string.
 string pad_string_centre(const string& str, unsigned int min_len, bool ansi)
 {
-    string output = str;
-    uint32_t len = (ansi ? ansi_strlen(str) : str.size());
-    if (len < min_len)
+    string output;
+    pad_string_centre(output, str, min_len, ansi);
+    return output;
+}
+
+// As above, but appends the result to a string or buffer.
+void pad_string_centre(StringSink out, std::string_view str, unsigned int min_len, bool ansi)
+{
+    const size_t len = (ansi ? ansi_strlen(str) : str.size());
+    if (len >= min_len)
     {
-        const int padding = min_len - len;
-        const int left_padding = std::round(padding / 2.0f);
-        const int right_padding = padding - left_padding;
-        output = (left_padding ? string(left_padding, ' ') : "") + output + (right_padding ? string(right_padding, ' ') : "");
+        out += str;
+        return;
     }
-    return output;
+    // Any odd space goes on the left, as with rounding half the padding up.
+    const size_t padding = min_len - len;
+    const size_t left_padding = (padding + 1) / 2;
+    out.reserve(str.size() + padding);
+    out.append(left_padding, ' ').append(str).append(padding - left_padding, ' ');
 }
 
 // Allows adding conditional tags to a string in the form of [tag_name:conditional text here] and either including or removing the conditional text depending on
@@ -149,6 +190,43 @@ string strip_trailing_newlines(string str)
 }
 
 // Trims out leading, trailing, and excess (more than one at a time) spaces from a string.
-string trim_excess_spaces(const string& source) { return std::regex_replace(source, std::regex("^ +| +$|( ) +"), "$1"); }
+string trim_excess_spaces(string source)
+{
+    trim_excess_spaces_in_place(source);
+    return source;
+}
+
+// As above, but modifies the string in-place.
+void trim_excess_spaces_in_place(string& str)
+{
+    char* data = str.data();
+    const size_t len = str.size();
+    size_t read = 0, write = 0;
+    while (read < len && data[read] == ' ') read++;
+
+    while (read < len)
+    {
+#ifdef TRAILMIX_SIMD_SSE2
+        // Long stretches without any doubled-up spaces can be copied across sixteen bytes at a time.
+        if (len - read >= 16)
+        {
+            const uint32_t spaces = trailmix::internal::sse2_match_mask(data + read, ' ');
+            const bool follows_space = (write && data[write - 1] == ' ');
+            if (!(spaces & (spaces >> 1)) && !(follows_space && (spaces & 1)))
+            {
+                if (write != read) std::memmove(data + write, data + read, 16);
+                write += 16;
+                read += 16;
+                continue;
+            }
+        }
+#endif
+        const char ch = data[read++];
+        if (ch == ' ' && write && data[write - 1] == ' ') continue;
+        data[write++] = ch;
+    }
+    if (write && data[write - 1] == ' ') write--;
+    str.resize(write);
+}
 
 }   // namespace trailmix::text::formatting
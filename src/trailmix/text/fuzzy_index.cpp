@@ -0,0 +1,224 @@
+// text/fuzzy_index.cpp -- FuzzyIndex finds the closest matches for a piece of text (such as a player's typed input) among a large set of strings. The strings
+// are interned in a StringPool and indexed by their trigrams, so only plausible candidates are scored, using a bit-parallel edit distance.
+
+// SPDX-FileType: SOURCE
+// SPDX-FileCopyrightText: Copyright 2025 Raine Simmons <gc@gravecat.com>
+// SPDX-License-Identifier: MIT
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+#include "trailmix/internal/ascii.hpp"
+#include "trailmix/text/fuzzy_index.hpp"
+
+using std::runtime_error;
+using std::string_view;
+using std::vector;
+using trailmix::internal::ascii_fold;
+
+namespace trailmix::text {
+
+namespace {
+
+// Collects the distinct trigrams in a string, case-folded and packed into 24 bits each, optionally padding the string with a space at either end.
+void collect_trigrams(string_view str, bool pad, vector<uint32_t>& trigrams)
+{
+    trigrams.clear();
+    const size_t len = str.size() + (pad ? 2 : 0);
+    if (len < 3) return;
+    auto char_at = [str, pad, len](size_t pos) -> uint32_t {
+        if (!pad) return ascii_fold(str[pos]);
+        if (pos == 0 || pos == len - 1) return ' ';
+        return ascii_fold(str[pos - 1]);
+    };
+    uint32_t trigram = (char_at(0) << 8) | char_at(1);
+    for (size_t pos = 2; pos < len; pos++)
+    {
+        trigram = ((trigram << 8) | char_at(pos)) & 0xFFFFFF;
+        trigrams.push_back(trigram);
+    }
+    std::sort(trigrams.begin(), trigrams.end());
+    trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+}
+
+// Checks if a string starts with another, ignoring the case of ASCII letters.
+bool starts_with_folded(string_view str, string_view prefix)
+{
+    if (prefix.size() > str.size()) return false;
+    for (size_t i = 0; i < prefix.size(); i++)
+        if (ascii_fold(str[i]) != ascii_fold(prefix[i])) return false;
+    return true;
+}
+
+// Works out the smallest number of edits needed to make a query appear anywhere within other strings, ignoring the case of ASCII letters. Queries up to 64
+// characters long use Myers' bit-parallel algorithm, which handles a whole column of the edit distance matrix at once; longer queries fall back on filling
+// in the matrix one column at a time.
+class SubstringMatcher
+{
+public:
+    explicit    SubstringMatcher(string_view query);    // Prepares to match a given query.
+    uint32_t    distance(string_view text); // Returns the edit distance between the query and its best match within the text.
+
+private:
+    vector<uint32_t>    column_;    // One column of the edit distance matrix, when the query is too long for the bit-parallel algorithm.
+    uint64_t    masks_[256];        // For each character, which positions in the query it appears at.
+    string_view query_;             // The query being matched.
+};
+
+// Prepares to match a given query.
+SubstringMatcher::SubstringMatcher(string_view query) : masks_(), query_(query)
+{
+    if (query.size() > 64) column_.resize(query.size() + 1);
+    else for (size_t i = 0; i < query.size(); i++)
+        masks_[ascii_fold(query[i])] |= (1ULL << i);
+}
+
+// Returns the edit distance between the query and its best match within the text.
+uint32_t SubstringMatcher::distance(string_view text)
+{
+    const size_t len = query_.size();
+    if (!len) return 0;
+    uint32_t best = static_cast<uint32_t>(len);
+    if (len <= 64)
+    {
+        // Pv and Mv track where the score goes up or down by one between each row of the current column; the score itself is the bottom row. Unlike global
+        // edit distance, the top row is always zero, so a match can begin anywhere in the text.
+        const uint64_t last_bit = 1ULL << (len - 1);
+        uint64_t pv = ~0ULL, mv = 0;
+        uint32_t score = static_cast<uint32_t>(len);
+        for (char ch : text)
+        {
+            const uint64_t eq = masks_[ascii_fold(ch)];
+            const uint64_t xv = eq | mv;
+            const uint64_t xh = (((eq & pv) + pv) ^ pv) | eq;
+            uint64_t ph = mv | ~(xh | pv);
+            uint64_t mh = pv & xh;
+            if (ph & last_bit) score++;
+            else if (mh & last_bit) score--;
+            ph <<= 1;
+            mh <<= 1;
+            pv = mh | ~(xv | ph);
+            mv = ph & xv;
+            best = std::min(best, score);
+        }
+        return best;
+    }
+
+    for (size_t row = 0; row <= len; row++)
+        column_[row] = static_cast<uint32_t>(row);
+    for (char ch : text)
+    {
+        uint32_t diagonal = column_[0];
+        for (size_t row = 1; row <= len; row++)
+        {
+            const uint32_t above = column_[row];
+            column_[row] = std::min({above + 1, column_[row - 1] + 1, diagonal + (ascii_fold(query_[row - 1]) != ascii_fold(ch))});
+            diagonal = above;
+        }
+        best = std::min(best, column_[len]);
+    }
+    return best;
+}
+
+}   // anonymous namespace
+
+// Creates an empty index, with its own string pool.
+FuzzyIndex::FuzzyIndex() : own_pool_(std::make_unique<StringPool>()), pool_(own_pool_.get()) { }
+
+// Creates an empty index, which interns its strings in an existing pool.
+FuzzyIndex::FuzzyIndex(StringPool& pool) : pool_(&pool) { }
+
+// Adds a string to the index, and returns its ID. Adding the same string again returns the same ID.
+uint32_t FuzzyIndex::add(string_view str)
+{
+    const InternedString interned = pool_->intern(str);
+    const auto found = ids_.find(interned);
+    if (found != ids_.end()) return found->second;
+    if (strings_.size() >= UINT32_MAX) throw runtime_error("Too many strings in FuzzyIndex!");
+
+    const uint32_t id = static_cast<uint32_t>(strings_.size());
+    strings_.push_back(interned);
+    ids_.emplace(interned, id);
+    vector<uint32_t> trigrams;
+    collect_trigrams(str, true, trigrams);
+    for (uint32_t trigram : trigrams)
+        trigrams_[trigram].push_back(id);
+    return id;
+}
+
+// Removes all strings from the index. Any strings already interned stay in the pool.
+void FuzzyIndex::clear()
+{
+    ids_.clear();
+    strings_.clear();
+    trigrams_.clear();
+}
+
+// Returns the string with a given ID. Throws if the ID is invalid.
+InternedString FuzzyIndex::get(uint32_t id) const
+{
+    if (id >= strings_.size()) throw runtime_error("Invalid FuzzyIndex ID: " + std::to_string(id));
+    return strings_[id];
+}
+
+// Finds up to max_results strings within max_distance edits of the query, best matches first.
+vector<FuzzyMatch> FuzzyIndex::search(string_view query, size_t max_results, uint32_t max_distance) const
+{
+    vector<FuzzyMatch> results;
+    search(query, max_results, max_distance, results);
+    return results;
+}
+
+// As above, but writes the results into an existing vector, which is cleared first but keeps its capacity.
+void FuzzyIndex::search(string_view query, size_t max_results, uint32_t max_distance, vector<FuzzyMatch>& results) const
+{
+    results.clear();
+    if (!max_results || strings_.empty()) return;
+    SubstringMatcher matcher(query);
+    auto score = [&](uint32_t id) {
+        const string_view text = strings_[id].view();
+        if (text.size() + max_distance < query.size()) return;  // Too short to possibly be close enough.
+        const uint32_t distance = matcher.distance(text);
+        if (distance <= max_distance) results.push_back({distance, id, strings_[id]});
+    };
+
+    // Each edit can break at most three of the query's trigrams, so any string close enough to match must share the rest of them with the query. If that
+    // leaves nothing to go on (a short query, or a generous max_distance), every string has to be checked, but scoring each one is still fast.
+    vector<uint32_t> trigrams;
+    collect_trigrams(query, false, trigrams);
+    const size_t required = (trigrams.size() > 3ULL * max_distance ? trigrams.size() - 3ULL * max_distance : 0);
+    if (required)
+    {
+        vector<uint32_t> candidates;
+        for (uint32_t trigram : trigrams)
+        {
+            const auto found = trigrams_.find(trigram);
+            if (found != trigrams_.end()) candidates.insert(candidates.end(), found->second.begin(), found->second.end());
+        }
+        std::sort(candidates.begin(), candidates.end());
+        for (size_t start = 0, end = 0; start < candidates.size(); start = end)
+        {
+            while (end < candidates.size() && candidates[end] == candidates[start]) end++;
+            if (end - start >= required) score(candidates[start]);
+        }
+    }
+    else for (uint32_t id = 0; id < strings_.size(); id++)
+        score(id);
+
+    auto better = [query](const FuzzyMatch& a, const FuzzyMatch& b) {
+        if (a.distance != b.distance) return a.distance < b.distance;
+        const bool a_prefix = starts_with_folded(a.text.view(), query), b_prefix = starts_with_folded(b.text.view(), query);
+        if (a_prefix != b_prefix) return a_prefix;
+        if (a.text.size() != b.text.size()) return a.text.size() < b.text.size();
+        return a.id < b.id;
+    };
+    if (results.size() > max_results)
+    {
+        std::partial_sort(results.begin(), results.begin() + static_cast<std::ptrdiff_t>(max_results), results.end(), better);
+        results.resize(max_results);
+    }
+    else std::sort(results.begin(), results.end(), better);
+}
+
+}   // namespace trailmix::text
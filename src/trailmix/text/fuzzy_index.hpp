@@ -0,0 +1,54 @@
+// text/fuzzy_index.hpp -- FuzzyIndex finds the closest matches for a piece of text (such as a player's typed input) among a large set of strings. The strings
+// are interned in a StringPool and indexed by their trigrams, so only plausible candidates are scored, using a bit-parallel edit distance.
+
+// SPDX-FileType: SOURCE
+// SPDX-FileCopyrightText: Copyright 2025 Raine Simmons <gc@gravecat.com>
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+#include "trailmix/container/flat_hash_map.hpp"
+#include "trailmix/text/string_pool.hpp"
+
+namespace trailmix::text {
+
+// A single result from a FuzzyIndex search.
+struct FuzzyMatch
+{
+    uint32_t        distance;   // The number of edits needed to make the query appear somewhere within the string.
+    uint32_t        id;         // The ID returned by FuzzyIndex::add() when this string was added.
+    InternedString  text;       // The string that was matched.
+};
+
+// Matching is case-insensitive (for ASCII letters), and finds the query anywhere within each string, so "swrd" matches "Long Sword" at a distance of 1.
+// Searching is safe from multiple threads at once, but adding strings is not safe while searching.
+class FuzzyIndex
+{
+public:
+                FuzzyIndex();               // Creates an empty index, with its own string pool.
+    explicit    FuzzyIndex(StringPool& pool);   // Creates an empty index, which interns its strings in an existing pool.
+    uint32_t    add(std::string_view str);  // Adds a string to the index, and returns its ID. Adding the same string again returns the same ID.
+    void        clear();                    // Removes all strings from the index. Any strings already interned stay in the pool.
+    InternedString  get(uint32_t id) const; // Returns the string with a given ID. Throws if the ID is invalid.
+                // Finds up to max_results strings within max_distance edits of the query, best matches first. Ties are broken in favour of strings that
+                // start with the query, then shorter strings, then strings added earlier.
+    std::vector<FuzzyMatch> search(std::string_view query, size_t max_results, uint32_t max_distance = 2) const;
+                // As above, but writes the results into an existing vector, which is cleared first but keeps its capacity.
+    void        search(std::string_view query, size_t max_results, uint32_t max_distance, std::vector<FuzzyMatch>& results) const;
+    size_t      size() const { return strings_.size(); }    // Returns the number of strings in the index.
+
+private:
+    container::FlatHashMap<InternedString, uint32_t>        ids_;       // Looks up the ID of each string in the index.
+    std::unique_ptr<StringPool>                             own_pool_;  // The index's own string pool, if it wasn't given one.
+    StringPool*                                             pool_;      // The pool that strings are interned in.
+    std::vector<InternedString>                             strings_;   // Every string in the index, by ID.
+    container::FlatHashMap<uint32_t, std::vector<uint32_t>> trigrams_;  // The IDs of the strings containing each trigram, in ascending order.
+};
+
+}   // namespace trailmix::text
@@ -4,12 +4,16 @@
 // SPDX-FileCopyrightText: Copyright 2025 Raine Simmons <gc@gravecat.com>
 // SPDX-License-Identifier: MIT
 
-#ifdef TRAILMIX_BUILD_DEBUG
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cstring>
 #include <iostream>
-#include <map>
-#endif
+#include <mutex>
+#include <unordered_map>
 
 #include "3rdparty/murmurhash3/MurmurHash3.h"
+#include "trailmix/internal/hash_combine.hpp"
 #include "trailmix/text/hash.hpp"
 
 using std::string;
@@ -17,65 +21,386 @@ using std::to_string;
 
 namespace trailmix::text::hash {
 
-// Hashes a string with the djb2 algorithm.
-uint32_t djb2(const string& str)
+namespace {
+
+static constexpr uint64_t MURMUR3_C1 = 0x87c37b91114253d5ULL, MURMUR3_C2 = 0x4cf5ad432745937fULL;  // The MurmurHash3 x64 multiplication constants.
+static constexpr uint64_t XXH64_PRIME_1 = 11400714785074694791ULL, XXH64_PRIME_2 = 14029467366897019727ULL, XXH64_PRIME_3 = 1609587929392839161ULL,
+    XXH64_PRIME_4 = 9650029242287828579ULL, XXH64_PRIME_5 = 2870177450012600261ULL;    // The XXH64 primes.
+
+// Reads a native-endian 64-bit integer from unaligned memory. MurmurHash3 is defined by the vendored code, which reads its blocks this way.
+uint64_t read_native64(const char* ptr)
+{
+    uint64_t result;
+    std::memcpy(&result, ptr, sizeof(result));
+    return result;
+}
+
+// Reads a little-endian 32-bit integer from unaligned memory, byte-swapping it on big-endian hosts. XXH64 is defined in little-endian terms.
+uint32_t read_le32(const char* ptr)
+{
+    uint32_t result;
+    std::memcpy(&result, ptr, sizeof(result));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    result = __builtin_bswap32(result);
+#endif
+    return result;
+}
+
+// As above, but for a 64-bit integer.
+uint64_t read_le64(const char* ptr)
 {
-    uint32_t hash = 5381;
-    for (char c : str)
-        hash = ((hash << 5) + hash) + static_cast<unsigned char>(c);    // hash * 33 + c
+    uint64_t result = read_native64(ptr);
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    result = __builtin_bswap64(result);
+#endif
+    return result;
+}
+
+// Rotates a 64-bit integer left.
+constexpr uint64_t rotl64(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
 
 #ifdef TRAILMIX_BUILD_DEBUG
-    check_hash_collision(str, hash);
+static constexpr uint32_t DEFAULT_COLLISION_SAMPLING = 1;   // In debug builds, every hash is checked for collisions by default.
+#else
+static constexpr uint32_t DEFAULT_COLLISION_SAMPLING = 0;   // In release builds, collision checks are off by default.
 #endif
+static constexpr size_t COLLISION_ENTRY_OVERHEAD = 64;      // A rough guess at the memory used by each entry in the collision table, not counting the string.
+static constexpr size_t COLLISION_SHARDS = 64;              // The number of separately-locked shards in the collision table.
+
+// One shard of the collision table. Each has its own lock, so threads hashing different strings rarely wait on each other.
+struct CollisionShard
+{
+    size_t                                  memory_used = 0;    // Roughly how much memory this shard's entries are using.
+    std::mutex                              mutex;  // Locks this shard.
+    std::unordered_map<uint64_t, string>    seen;   // The first string seen with each hash, keyed by the algorithm in the upper 32 bits and the hash below.
+};
+
+std::atomic<size_t>     collision_count(0);         // How many collisions have been detected so far.
+std::atomic<size_t>     collision_memory_limit(64 * 1024 * 1024);   // Roughly how much memory the collision table is allowed to use.
+std::atomic<size_t>     collision_memory_used(0);   // Roughly how much memory the collision table is using.
+std::atomic<uint32_t>   collision_sampling(DEFAULT_COLLISION_SAMPLING); // Checks one in every N hashes, or none if 0.
+CollisionShard          collision_shards[COLLISION_SHARDS]; // The collision table itself.
+
+// Checks a hash for collisions, if it's one of the hashes being sampled.
+inline void sample_hash_collision(std::string_view str, uint32_t hash, HashAlgorithm algorithm)
+{
+    const uint32_t sampling = collision_sampling.load(std::memory_order_relaxed);
+    if (sampling && hash % sampling == 0) check_hash_collision(str, hash, algorithm);
+}
+
+// Reserves memory for a new entry in the collision table, or returns false if that would go over the memory limit.
+bool reserve_collision_memory(size_t bytes)
+{
+    size_t used = collision_memory_used.load(std::memory_order_relaxed);
+    do
+    {
+        if (used + bytes > collision_memory_limit.load(std::memory_order_relaxed)) return false;
+    } while (!collision_memory_used.compare_exchange_weak(used, used + bytes, std::memory_order_relaxed));
+    return true;
+}
+
+// Mixes one 64-bit lane of input into an XXH64 accumulator.
+constexpr uint64_t xxh64_round(uint64_t acc, uint64_t input)
+{
+    acc += input * XXH64_PRIME_2;
+    acc = rotl64(acc, 31);
+    return acc * XXH64_PRIME_1;
+}
+
+// Merges one of the four XXH64 accumulators into the final hash.
+constexpr uint64_t xxh64_merge(uint64_t hash, uint64_t acc)
+{
+    hash ^= xxh64_round(0, acc);
+    return hash * XXH64_PRIME_1 + XXH64_PRIME_4;
+}
+
+}   // anonymous namespace
+
+// Hashes a string with the djb2 algorithm.
+uint32_t djb2(std::string_view str)
+{
+    const uint32_t hash = djb2_constexpr(str);
+
+    sample_hash_collision(str, hash, HashAlgorithm::DJB2);
 
     return hash;
 }
 
 // Hashes a string with the FNV algorithm.
-uint32_t fnv(const std::string& str)
+uint32_t fnv(std::string_view str)
 {
-    uint32_t result = 2166136261U;
-    std::string::const_iterator end = str.end();
-    for (std::string::const_iterator iter = str.begin(); iter != end; ++iter)
-        result = 127 * result + static_cast<unsigned char>(*iter);
+    const uint32_t result = fnv_constexpr(str);
 
-#ifdef TRAILMIX_BUILD_DEBUG
-    check_hash_collision(str, result);
-#endif
+    sample_hash_collision(str, result, HashAlgorithm::FNV);
 
     return result;
 }
 
 // Hashes a string with MurmurHash3.
-uint32_t murmur3(const string& str)
+uint32_t murmur3(std::string_view str)
 {
-    const uint32_t seed = 0x9747b28c;
     uint32_t hash = 0;  // Shouldn't matter, but I don't like uninitialized variables on principle.
-    MurmurHash3_x86_32(str.data(), static_cast<int>(str.size()), seed, &hash);
+    MurmurHash3_x86_32(str.data(), static_cast<int>(str.size()), MURMUR3_SEED, &hash);
 
-#ifdef TRAILMIX_BUILD_DEBUG
-    check_hash_collision(str, hash);
-#endif
+    sample_hash_collision(str, hash, HashAlgorithm::MURMUR3);
 
     return hash;
 }
 
-// Only in debug builds, we're gonna add some extra code to detect hash collisions in real-time. Yes, it'll slow performance by a tiny amount, but it's a
-// debug build, we're not expecting maximum optimization and speed here.
-#ifdef TRAILMIX_BUILD_DEBUG
-std::map<uint32_t, string> backward_hash_map;
+// Hashes a string with the 128-bit x64 version of MurmurHash3.
+Hash128 murmur3_128(std::string_view str, uint32_t seed)
+{
+    // The vendored code takes an int length, so only strings longer than that need the streaming version.
+    if (str.size() > INT_MAX)
+    {
+        Murmur3Hasher hasher(seed);
+        hasher.update(str);
+        return hasher.digest();
+    }
+    uint64_t hash[2] = {0, 0};
+    MurmurHash3_x64_128(str.data(), static_cast<int>(str.size()), seed, hash);
+    return {hash[0], hash[1]};
+}
+
+// As above, but returns only the lower 64 bits.
+uint64_t murmur3_64(std::string_view str, uint32_t seed) { return murmur3_128(str, seed).low; }
+
+// Hashes a string with XXH64, which is very fast on longer strings.
+uint64_t xxh64(std::string_view str, uint64_t seed)
+{
+    Xxh64Hasher hasher(seed);
+    hasher.update(str);
+    return hasher.digest();
+}
+
+// Adds more data to the hash.
+void Fnv1aHasher::update(std::string_view data)
+{
+    for (char c : data)
+        hash_ = (hash_ ^ static_cast<unsigned char>(c)) * FNV1A_64_PRIME;
+}
+
+// Starts a new hash with the specified seed.
+Murmur3Hasher::Murmur3Hasher(uint32_t seed) : seed_(seed) { reset(); }
 
-void check_hash_collision(const string& str, uint32_t hash)
+// Returns the hash of all the data so far.
+Hash128 Murmur3Hasher::digest() const
 {
-    auto result_b = backward_hash_map.find(hash);
-    if (result_b == backward_hash_map.end())
+    uint64_t h1 = h1_, h2 = h2_, k1 = 0, k2 = 0;
+    const auto tail = reinterpret_cast<const unsigned char*>(buffer_);
+    for (size_t i = buffer_size_; i > 8; i--)
+        k2 |= static_cast<uint64_t>(tail[i - 1]) << ((i - 9) * 8);
+    if (buffer_size_ > 8)
     {
-        backward_hash_map.insert({hash, str});
-        return;
+        k2 *= MURMUR3_C2;
+        k2 = rotl64(k2, 33);
+        k2 *= MURMUR3_C1;
+        h2 ^= k2;
     }
-    if (!result_b->second.compare(str)) return;
-   std::cerr << "Hash collision detected! " + str + " and " + result_b->second + " both hash to " + to_string(hash);
+    for (size_t i = (buffer_size_ > 8 ? 8 : buffer_size_); i > 0; i--)
+        k1 |= static_cast<uint64_t>(tail[i - 1]) << ((i - 1) * 8);
+    if (buffer_size_)
+    {
+        k1 *= MURMUR3_C1;
+        k1 = rotl64(k1, 31);
+        k1 *= MURMUR3_C2;
+        h1 ^= k1;
+    }
+
+    h1 ^= total_len_;
+    h2 ^= total_len_;
+    h1 += h2;
+    h2 += h1;
+    h1 = internal::hash_mix(h1);
+    h2 = internal::hash_mix(h2);
+    h1 += h2;
+    h2 += h1;
+    return {h1, h2};
+}
+
+// Mixes a full 16-byte block into the hash.
+void Murmur3Hasher::process_block(const char* block)
+{
+    uint64_t k1 = read_native64(block), k2 = read_native64(block + 8);
+    k1 *= MURMUR3_C1;
+    k1 = rotl64(k1, 31);
+    k1 *= MURMUR3_C2;
+    h1_ ^= k1;
+    h1_ = rotl64(h1_, 27);
+    h1_ += h2_;
+    h1_ = h1_ * 5 + 0x52dce729;
+
+    k2 *= MURMUR3_C2;
+    k2 = rotl64(k2, 33);
+    k2 *= MURMUR3_C1;
+    h2_ ^= k2;
+    h2_ = rotl64(h2_, 31);
+    h2_ += h1_;
+    h2_ = h2_ * 5 + 0x38495ab5;
+}
+
+// Starts again from scratch, with the same seed.
+void Murmur3Hasher::reset()
+{
+    buffer_size_ = 0;
+    h1_ = h2_ = seed_;
+    total_len_ = 0;
+}
+
+// Adds more data to the hash.
+void Murmur3Hasher::update(std::string_view data)
+{
+    total_len_ += data.size();
+    const char* ptr = data.data();
+    const char* const end = ptr + data.size();
+    if (buffer_size_)
+    {
+        const size_t to_copy = std::min(sizeof(buffer_) - buffer_size_, data.size());
+        std::memcpy(buffer_ + buffer_size_, ptr, to_copy);
+        buffer_size_ += to_copy;
+        ptr += to_copy;
+        if (buffer_size_ < sizeof(buffer_)) return;
+        process_block(buffer_);
+        buffer_size_ = 0;
+    }
+    for (; end - ptr >= 16; ptr += 16)
+        process_block(ptr);
+    std::memcpy(buffer_, ptr, end - ptr);
+    buffer_size_ = end - ptr;
 }
-#endif  // TRAILMIX_BUILD_DEBUG
+
+// Starts a new hash with the specified seed.
+Xxh64Hasher::Xxh64Hasher(uint64_t seed) : seed_(seed) { reset(); }
+
+// Returns the hash of all the data so far.
+uint64_t Xxh64Hasher::digest() const
+{
+    uint64_t hash;
+    if (total_len_ >= 32)
+    {
+        hash = rotl64(acc_[0], 1) + rotl64(acc_[1], 7) + rotl64(acc_[2], 12) + rotl64(acc_[3], 18);
+        for (auto acc : acc_)
+            hash = xxh64_merge(hash, acc);
+    }
+    else hash = seed_ + XXH64_PRIME_5;
+    hash += total_len_;
+
+    const char* ptr = buffer_;
+    const char* const end = buffer_ + buffer_size_;
+    for (; end - ptr >= 8; ptr += 8)
+    {
+        hash ^= xxh64_round(0, read_le64(ptr));
+        hash = rotl64(hash, 27) * XXH64_PRIME_1 + XXH64_PRIME_4;
+    }
+    if (end - ptr >= 4)
+    {
+        hash ^= static_cast<uint64_t>(read_le32(ptr)) * XXH64_PRIME_1;
+        hash = rotl64(hash, 23) * XXH64_PRIME_2 + XXH64_PRIME_3;
+        ptr += 4;
+    }
+    for (; ptr < end; ptr++)
+    {
+        hash ^= static_cast<unsigned char>(*ptr) * XXH64_PRIME_5;
+        hash = rotl64(hash, 11) * XXH64_PRIME_1;
+    }
+
+    hash ^= hash >> 33;
+    hash *= XXH64_PRIME_2;
+    hash ^= hash >> 29;
+    hash *= XXH64_PRIME_3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+// Mixes a full 32-byte stripe into the hash.
+void Xxh64Hasher::process_stripe(const char* stripe)
+{
+    for (int i = 0; i < 4; i++)
+        acc_[i] = xxh64_round(acc_[i], read_le64(stripe + i * 8));
+}
+
+// Starts again from scratch, with the same seed.
+void Xxh64Hasher::reset()
+{
+    acc_[0] = seed_ + XXH64_PRIME_1 + XXH64_PRIME_2;
+    acc_[1] = seed_ + XXH64_PRIME_2;
+    acc_[2] = seed_;
+    acc_[3] = seed_ - XXH64_PRIME_1;
+    buffer_size_ = 0;
+    total_len_ = 0;
+}
+
+// Adds more data to the hash.
+void Xxh64Hasher::update(std::string_view data)
+{
+    total_len_ += data.size();
+    const char* ptr = data.data();
+    const char* const end = ptr + data.size();
+    if (buffer_size_)
+    {
+        const size_t to_copy = std::min(sizeof(buffer_) - buffer_size_, data.size());
+        std::memcpy(buffer_ + buffer_size_, ptr, to_copy);
+        buffer_size_ += to_copy;
+        ptr += to_copy;
+        if (buffer_size_ < sizeof(buffer_)) return;
+        process_stripe(buffer_);
+        buffer_size_ = 0;
+    }
+    for (; end - ptr >= 32; ptr += 32)
+        process_stripe(ptr);
+    std::memcpy(buffer_, ptr, end - ptr);
+    buffer_size_ = end - ptr;
+}
+
+// Checks a string and its hash against all those seen so far from the same algorithm.
+void check_hash_collision(std::string_view str, uint32_t hash, HashAlgorithm algorithm)
+{
+    static constexpr const char* ALGORITHM_NAMES[] = { "djb2", "fnv", "murmur3", "an unspecified hash" };
+    const uint64_t key = (static_cast<uint64_t>(algorithm) << 32) | hash;
+
+    // The shard is picked with the upper bits of the hash, as sampling uses the lower bits.
+    CollisionShard& shard = collision_shards[(hash >> 26) % COLLISION_SHARDS];
+    string other;
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto found = shard.seen.find(key);
+        if (found == shard.seen.end())
+        {
+            // Once the memory limit is reached, new strings are no longer remembered, but they can still collide with the ones already seen.
+            const size_t entry_size = str.size() + COLLISION_ENTRY_OVERHEAD;
+            if (!reserve_collision_memory(entry_size)) return;
+            shard.memory_used += entry_size;
+            shard.seen.emplace(key, string(str));
+            return;
+        }
+        if (!found->second.compare(str)) return;
+        other = found->second;
+    }
+    collision_count.fetch_add(1, std::memory_order_relaxed);
+    std::cerr << "Hash collision detected! " + string(str) + " and " + other + " both hash to " + to_string(hash) + " with " +
+        ALGORITHM_NAMES[static_cast<size_t>(algorithm)] + "\n";
+}
+
+// Forgets every string seen so far and resets the collision count, freeing up the memory limit.
+void clear_hash_collisions()
+{
+    for (auto& shard : collision_shards)
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.seen.clear();
+        collision_memory_used.fetch_sub(shard.memory_used, std::memory_order_relaxed);
+        shard.memory_used = 0;
+    }
+    collision_count.store(0, std::memory_order_relaxed);
+}
+
+// Returns how many hash collisions have been detected so far.
+size_t hash_collisions_detected() { return collision_count.load(std::memory_order_relaxed); }
+
+// Sets roughly how much memory the collision detector can use before it stops remembering new strings.
+void set_collision_memory_limit(size_t bytes) { collision_memory_limit.store(bytes, std::memory_order_relaxed); }
+
+// Checks one in every N hashes for collisions, or none at all if set to 0.
+void set_collision_sampling(uint32_t one_in) { collision_sampling.store(one_in, std::memory_order_relaxed); }
 
 }   // namespace trailmix::text::hash
@@ -6,18 +6,138 @@
 
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
+#include <string_view>
 
 namespace trailmix::text::hash {
 
-uint32_t    djb2(const std::string& str);       // Hashes a string with the djb2 algorithm.
-uint32_t    fnv(const std::string& str);        // Hashes a string with the FNV algorithm.
-uint32_t    murmur3(const std::string& str);    // Hashes a string with MurmurHash3.
+static constexpr uint32_t FNV1A_32_OFFSET = 2166136261U, FNV1A_32_PRIME = 16777619U;  // The 32-bit FNV-1a offset basis and prime.
+static constexpr uint64_t FNV1A_64_OFFSET = 14695981039346656037ULL, FNV1A_64_PRIME = 1099511628211ULL; // The 64-bit FNV-1a offset basis and prime.
+static constexpr uint32_t MURMUR3_SEED = 0x9747b28c;   // The default seed used for MurmurHash3.
 
-// Only in debug builds, we're gonna add some extra code to detect hash collisions in real-time. Yes, it'll slow performance by a tiny amount, but it's a
-// debug build, we're not expecting maximum optimization and speed here.
-#ifdef TRAILMIX_BUILD_DEBUG
-void        check_hash_collision(const std::string& str, uint32_t hash);
-#endif
+// A 128-bit hash result.
+struct Hash128
+{
+    uint64_t    low, high;  // The lower and upper 64 bits of the hash.
+    bool        operator==(const Hash128& other) const { return low == other.low && high == other.high; }
+    bool        operator!=(const Hash128& other) const { return !(*this == other); }
+};
+
+uint32_t    djb2(std::string_view str);         // Hashes a string with the djb2 algorithm.
+            // Hashes a string with the multiply-by-127 hash this library has always called FNV. This isn't really FNV; for that, see fnv1a_32() and fnv1a_64().
+uint32_t    fnv(std::string_view str);
+uint32_t    murmur3(std::string_view str);      // Hashes a string with MurmurHash3.
+Hash128     murmur3_128(std::string_view str, uint32_t seed = MURMUR3_SEED);   // Hashes a string with the 128-bit x64 version of MurmurHash3.
+uint64_t    murmur3_64(std::string_view str, uint32_t seed = MURMUR3_SEED);    // As above, but returns only the lower 64 bits.
+uint64_t    xxh64(std::string_view str, uint64_t seed = 0);    // Hashes a string with XXH64, which is very fast on longer strings.
+
+// Streaming version of fnv1a_64(), for hashing data that arrives in pieces.
+class Fnv1aHasher
+{
+public:
+    uint64_t    digest() const { return hash_; }    // Returns the hash of all the data so far.
+    void        reset() { hash_ = FNV1A_64_OFFSET; }    // Starts again from scratch.
+    void        update(std::string_view data);      // Adds more data to the hash.
+
+private:
+    uint64_t    hash_ = FNV1A_64_OFFSET;    // The hash so far.
+};
+
+// Streaming version of murmur3_128(), for hashing data that arrives in pieces. The vendored MurmurHash3 code has no streaming interface, so this mirrors
+// its MurmurHash3_x64_128() one block at a time, and gives identical results.
+class Murmur3Hasher
+{
+public:
+                Murmur3Hasher(uint32_t seed = MURMUR3_SEED);    // Starts a new hash with the specified seed.
+    Hash128     digest() const;                     // Returns the hash of all the data so far.
+    void        reset();                            // Starts again from scratch, with the same seed.
+    void        update(std::string_view data);      // Adds more data to the hash.
+
+private:
+    void        process_block(const char* block);   // Mixes a full 16-byte block into the hash.
+
+    char        buffer_[16];    // Data which hasn't yet made up a full block.
+    size_t      buffer_size_;   // How much of the buffer is in use.
+    uint64_t    h1_, h2_;       // The hash state.
+    uint32_t    seed_;          // The seed this hash started with.
+    uint64_t    total_len_;     // The total length of all the data so far.
+};
+
+// Streaming version of xxh64(), for hashing data that arrives in pieces.
+class Xxh64Hasher
+{
+public:
+                Xxh64Hasher(uint64_t seed = 0); // Starts a new hash with the specified seed.
+    uint64_t    digest() const;                 // Returns the hash of all the data so far.
+    void        reset();                        // Starts again from scratch, with the same seed.
+    void        update(std::string_view data);  // Adds more data to the hash.
+
+private:
+    void        process_stripe(const char* stripe); // Mixes a full 32-byte stripe into the hash.
+
+    uint64_t    acc_[4];        // The four accumulators.
+    char        buffer_[32];    // Data which hasn't yet made up a full stripe.
+    size_t      buffer_size_;   // How much of the buffer is in use.
+    uint64_t    seed_;          // The seed this hash started with.
+    uint64_t    total_len_;     // The total length of all the data so far.
+};
+
+// Compile-time versions of djb2() and fnv(), which give the same results. These can be used for things like case labels in a switch on a hashed string.
+// They're separate functions rather than making djb2() and fnv() themselves constexpr, because the runtime versions feed the hash collision detector,
+// which can't run at compile time. For the same reason, these versions are never checked for collisions.
+constexpr uint32_t djb2_constexpr(std::string_view str)
+{
+    uint32_t hash = 5381;
+    for (char c : str)
+        hash = ((hash << 5) + hash) + static_cast<unsigned char>(c);    // hash * 33 + c
+    return hash;
+}
+
+constexpr uint32_t fnv_constexpr(std::string_view str)
+{
+    uint32_t result = 2166136261U;
+    for (char c : str)
+        result = 127 * result + static_cast<unsigned char>(c);
+    return result;
+}
+
+// The real FNV-1a hash, in 32-bit and 64-bit versions. These are constexpr, so they can also be used at compile time.
+constexpr uint32_t fnv1a_32(std::string_view str)
+{
+    uint32_t hash = FNV1A_32_OFFSET;
+    for (char c : str)
+        hash = (hash ^ static_cast<unsigned char>(c)) * FNV1A_32_PRIME;
+    return hash;
+}
+
+constexpr uint64_t fnv1a_64(std::string_view str)
+{
+    uint64_t hash = FNV1A_64_OFFSET;
+    for (char c : str)
+        hash = (hash ^ static_cast<unsigned char>(c)) * FNV1A_64_PRIME;
+    return hash;
+}
+
+namespace literals {
+
+// Hashes a string literal at compile time with djb2, so "look"_hash gives the same result as djb2("look").
+constexpr uint32_t operator""_hash(const char* str, size_t len) { return djb2_constexpr(std::string_view(str, len)); }
+
+}   // namespace literals
+
+// Hash collision detection. In debug builds, every string hashed with djb2(), fnv() or murmur3() is checked against all the others by default. In release
+// builds it's off by default, but can be switched on to check a sample of hashes, which is useful for soak tests. Sampling is done by hash value, so
+// two strings which collide are always either both checked or both skipped. Collisions are reported on stderr.
+// Each algorithm's hashes are tracked separately, so a djb2() hash which happens to equal an fnv() hash of a different string isn't a collision.
+enum class HashAlgorithm : uint8_t { DJB2, FNV, MURMUR3, OTHER };
+
+            // Checks a string and its hash against all those seen so far from the same algorithm.
+void        check_hash_collision(std::string_view str, uint32_t hash, HashAlgorithm algorithm = HashAlgorithm::OTHER);
+void        clear_hash_collisions();                    // Forgets every string seen so far and resets the collision count, freeing up the memory limit.
+size_t      hash_collisions_detected();                 // Returns how many hash collisions have been detected so far.
+void        set_collision_memory_limit(size_t bytes);   // Sets roughly how much memory the collision detector can use before it stops remembering new strings.
+void        set_collision_sampling(uint32_t one_in);    // Checks one in every N hashes for collisions, or none at all if set to 0.
 
 }   // namespace trailmix::text::hash
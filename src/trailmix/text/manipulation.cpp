@@ -5,61 +5,181 @@
 // SPDX-License-Identifier: MIT
 
 #include <algorithm>
-#include <numeric>
+#include <charconv>
+#include <functional>
 #include <sstream>
+#include <stdexcept>
 
+#include "trailmix/internal/simd.hpp"
 #include "trailmix/text/manipulation.hpp"
 
+using std::runtime_error;
 using std::string;
+using std::string_view;
 using std::to_string;
 using std::vector;
+using trailmix::text::StringSink;
 
 namespace trailmix::text::manipulation {
 
+namespace {
+
+// Flips the case of every character in a string which falls between first and last, 16 bytes at a time where possible. See internal::sse2_flip_case().
+void flip_case_in_place(string& str, char first, char last)
+{
+    char* data = str.data();
+    const size_t len = str.size();
+    size_t pos = 0;
+#ifdef TRAILMIX_SIMD_SSE2
+    for (; pos + 16 <= len; pos += 16)
+    {
+        const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(data + pos), internal::sse2_flip_case(block, first, last));
+    }
+#endif
+    for (; pos < len; pos++)
+        if (data[pos] >= first && data[pos] <= last) data[pos] ^= 0x20;
+}
+
+// Finds each unique string in a vector, returning the index of its first appearance and how many times it appears, in order of first appearance. Uses a
+// small open-addressing hash table of indices into the output, so this is linear time.
+vector<std::pair<size_t, size_t>> count_unique(const vector<string>& vec)
+{
+    static constexpr uint32_t EMPTY_SLOT = UINT32_MAX;
+    size_t table_size = 16;
+    while (table_size < vec.size() * 2) table_size *= 2;
+    vector<uint32_t> table(table_size, EMPTY_SLOT);
+    vector<size_t> hashes;
+    vector<std::pair<size_t, size_t>> unique;
+    hashes.reserve(vec.size());
+    unique.reserve(vec.size());
+
+    const std::hash<string_view> hasher;
+    for (size_t i = 0; i < vec.size(); i++)
+    {
+        const size_t hash = hasher(vec[i]);
+        size_t slot = hash & (table_size - 1);
+        while (true)
+        {
+            const uint32_t found = table[slot];
+            if (found == EMPTY_SLOT)
+            {
+                table[slot] = static_cast<uint32_t>(unique.size());
+                unique.push_back({i, 1});
+                hashes.push_back(hash);
+                break;
+            }
+            if (hashes[found] == hash && vec[unique[found].first] == vec[i])
+            {
+                unique[found].second++;
+                break;
+            }
+            slot = (slot + 1) & (table_size - 1);
+        }
+    }
+    return unique;
+}
+
+}   // anonymous namespace
+
 // Collapses a string vector list, combining duplicates.
 void collapse_list(vector<string>& vec)
 {
     if (vec.size() < 2) return;
-    for (unsigned int i = 0; i < vec.size(); i++)
+    const auto unique = count_unique(vec);
+    if (unique.size() == vec.size()) return;
+    for (size_t i = 0; i < unique.size(); i++)
     {
-        string entry = vec.at(i);
-        int total_count = 1;
-        for (unsigned int j = i + 1; j < vec.size(); j++)
+        // Each first appearance is always at or after its new position, so the strings can be moved down in-place.
+        if (unique[i].first != i) vec[i] = std::move(vec[unique[i].first]);
+        if (unique[i].second > 1)
         {
-            if (vec.at(j) == entry)
-            {
-                total_count++;
-                vec.erase(vec.begin() + j);
-                j--;
-            }
+            vec[i] += " (";
+            vec[i] += to_string(unique[i].second);
+            vec[i] += ')';
         }
-        if (total_count > 1) vec.at(i) = entry + " (" + to_string(total_count) + ")";
     }
+    vec.resize(unique.size());
+}
+
+// As above, but returns each unique string (in order of first appearance) along with how many times it appears, without modifying the vector.
+vector<std::pair<string_view, size_t>> collapse_list_counts(const vector<string>& vec)
+{
+    const auto unique = count_unique(vec);
+    vector<std::pair<string_view, size_t>> result;
+    result.reserve(unique.size());
+    for (const auto& entry : unique)
+        result.push_back({vec[entry.first], entry.second});
+    return result;
 }
 
 // Decodes a compressed string (e.g. 4cab2z becomes ccccabzz).
-string decode_compressed_string(string cb)
+string decode_compressed_string(string_view cb)
 {
+    // The first pass works out how long the decoded string will be, so the second can write it out without reallocating.
+    size_t decoded_len = 0, count = 0;
+    bool has_count = false;
+    for (char ch : cb)
+    {
+        if (ch >= '0' && ch <= '9')
+        {
+            count = count * 10 + (ch - '0');
+            if (count > INT32_MAX) throw runtime_error("Compressed string has an invalid count: " + string(cb));
+            has_count = true;
+        }
+        else
+        {
+            decoded_len += (has_count ? count : 1);
+            count = 0;
+            has_count = false;
+        }
+    }
+    if (has_count) throw runtime_error("Compressed string ends with a count: " + string(cb));
+
     string result;
-    while(cb.size())
+    result.reserve(decoded_len);
+    for (char ch : cb)
     {
-        string letter = cb.substr(0, 1);
-        cb = cb.substr(1);
-        if (letter[0] >= '0' && letter[0] <= '9')
+        if (ch >= '0' && ch <= '9')
         {
-            int number = letter[0] - '0';
-            letter = cb.substr(0, 1);
-            cb = cb.substr(1);
-            while (letter[0] >= '0' && letter[0] <= '9')
-            {
-                number *= 10;
-                number += letter[0] - '0';
-                letter = cb.substr(0, 1);
-                cb = cb.substr(1);
-            }
-            result += string(number, letter[0]);
+            count = count * 10 + (ch - '0');
+            has_count = true;
+        }
+        else
+        {
+            if (has_count) result.append(count, ch);
+            else result += ch;
+            count = 0;
+            has_count = false;
         }
-        else result += letter;
+    }
+    return result;
+}
+
+// Compresses a string which doesn't contain any digits (e.g. ccccabzz becomes 4cabzz).
+string encode_compressed_string(string_view str)
+{
+    string result;
+    result.reserve(str.size());
+    char count_buffer[20];
+    size_t pos = 0;
+    while (pos < str.size())
+    {
+        const char ch = str[pos];
+        if (ch >= '0' && ch <= '9') throw runtime_error("Cannot compress a string containing digits: " + string(str));
+        size_t run_end = pos + 1;
+        while (run_end < str.size() && str[run_end] == ch) run_end++;
+
+        // Runs of one or two characters are just as short (or shorter) left as they are.
+        const size_t run_len = run_end - pos;
+        if (run_len > 2)
+        {
+            const auto count_end = std::to_chars(count_buffer, count_buffer + sizeof(count_buffer), run_len).ptr;
+            result.append(count_buffer, count_end);
+            result += ch;
+        }
+        else result.append(run_len, ch);
+        pos = run_end;
     }
     return result;
 }
@@ -67,22 +187,46 @@ string decode_compressed_string(string cb)
 // Find and replace one string with another.
 bool find_and_replace(string& input, const string& to_find, const string& to_replace)
 {
-    string::size_type pos = 0;
-    const string::size_type find_len = to_find.length(), replace_len = to_replace.length();
+    const string::size_type find_len = to_find.length();
     if (find_len == 0) return false;
-    bool found = false;
-    while ((pos = input.find(to_find, pos)) != string::npos)
+    string::size_type pos = input.find(to_find);
+    if (pos == string::npos) return false;
+
+    // Build the result in a new buffer, rather than shifting the rest of the string along on every replacement.
+    string output;
+    output.reserve(input.size());
+    string::size_type copied = 0;
+    do
     {
-        found = true;
-        input.replace(pos, find_len, to_replace);
-        pos += replace_len;
-    }
-    return found;
+        output.append(input, copied, pos - copied);
+        output += to_replace;
+        copied = pos + find_len;
+    } while ((pos = input.find(to_find, copied)) != string::npos);
+    output.append(input, copied);
+    input.swap(output);
+    return true;
 }
 
 // Takes a vector of strings and squashes them into one string.
-string join_words(vector<string> vec, const string& spacer)
-{ return std::accumulate(vec.begin() + 1, vec.end(), vec[0], [&spacer](const string& a, const string& b) { return a + spacer + b; }); }
+string join_words(const vector<string>& vec, string_view spacer)
+{
+    string output;
+    join_words(output, vec, spacer);
+    return output;
+}
+
+// As above, but appends to a string or buffer.
+void join_words(StringSink out, const vector<string>& vec, string_view spacer)
+{
+    if (vec.empty()) return;
+    size_t total = spacer.size() * (vec.size() - 1);
+    for (const auto& word : vec)
+        total += word.size();
+    out.reserve(total);
+    out += vec[0];
+    for (size_t i = 1; i < vec.size(); i++)
+        out.append(spacer).append(vec[i]);
+}
 
 // Makes a string into a possessive noun (e.g. orc = orc's, platypus = platypus')
 string possessive_string(const string& str)
@@ -101,12 +245,36 @@ string replace_keep_capitalization(const string& input, const string& output)
     bool first_letter_caps = (input[0] >= 'A' && input[0] <= 'Z');
     bool all_caps = (input.size() > 2 && input[1] >= 'A' && input[1] <= 'Z');
 
-    if (all_caps) return str_toupper(result);
+    if (all_caps) str_toupper_in_place(result);
     else if (first_letter_caps && result[0] >= 'a' && result[0] <= 'z') result[0] -= 32;
 
     return result;
 }
 
+// Splits a string into a vector of views, which is cleared first but keeps its capacity.
+void split_into(std::string_view str, vector<std::string_view>& out, std::string_view separator)
+{
+    out.clear();
+    for (auto piece : split_view(str, separator))
+        out.push_back(piece);
+}
+
+// Splits a string into a vector of strings, reusing the vector's existing strings where possible.
+void split_into(std::string_view str, vector<string>& out, std::string_view separator)
+{
+    size_t count = 0;
+    for (auto piece : split_view(str, separator))
+    {
+        if (count < out.size()) out[count].assign(piece);
+        else out.emplace_back(piece);
+        count++;
+    }
+    out.resize(count);
+}
+
+// Splits a string lazily, yielding each piece as a std::string_view.
+SplitView split_view(std::string_view str, std::string_view separator) { return SplitView(str, separator); }
+
 // Repeats a string a number of times.
 std::string str_repeat(const std::string& source, unsigned int repeats)
 {
@@ -116,37 +284,31 @@ std::string str_repeat(const std::string& source, unsigned int repeats)
     return os.str();
 }
 
-// Converts a string to lower-case.
+// Converts a string to lower-case. Only ASCII letters are converted.
 string str_tolower(string str)
 {
-    std::transform(str.begin(), str.end(), str.begin(), ::tolower);
+    str_tolower_in_place(str);
     return str;
 }
 
-// Converts a string to upper-case.
+// As above, but modifies the string in-place.
+void str_tolower_in_place(string& str) { flip_case_in_place(str, 'A', 'Z'); }
+
+// Converts a string to upper-case. Only ASCII letters are converted.
 string str_toupper(string str)
 {
-    std::transform(str.begin(), str.end(), str.begin(), ::toupper);
+    str_toupper_in_place(str);
     return str;
 }
 
+// As above, but modifies the string in-place.
+void str_toupper_in_place(string& str) { flip_case_in_place(str, 'a', 'z'); }
+
 // String split/explode function.
-vector<string> string_explode(string str, const string& separator)
+vector<string> string_explode(std::string_view str, std::string_view separator)
 {
     vector<string> results;
-
-    string::size_type pos = str.find(separator, 0);
-    const size_t pit = separator.length();
-
-    while(pos != string::npos)
-    {
-        if (pos == 0) results.push_back("");
-        else results.push_back(str.substr(0, pos));
-        str.erase(0, pos + pit);
-        pos = str.find(separator, 0);
-    }
-    results.push_back(str);
-
+    split_into(str, results, separator);
     return results;
 }
 
@@ -6,22 +6,96 @@
 
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
+#include <iterator>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 
+#include "trailmix/text/string_sink.hpp"
+
 namespace trailmix::text::manipulation {
 
+// A lazy view of a string split by a separator, which yields each piece as a std::string_view without copying or allocating anything. The pieces are the same
+// as those returned by string_explode(), and only remain valid as long as the original string does.
+class SplitView
+{
+public:
+    class iterator
+    {
+    public:
+        using difference_type = std::ptrdiff_t;
+        using iterator_category = std::forward_iterator_tag;
+        using pointer = const std::string_view*;
+        using reference = const std::string_view&;
+        using value_type = std::string_view;
+
+                    iterator() = default;   // Creates an end iterator.
+                    iterator(std::string_view str, std::string_view separator) : end_(false), rest_(str), separator_(separator) { next(); }  // Finds the first piece.
+        reference   operator*() const { return piece_; }
+        pointer     operator->() const { return &piece_; }
+        iterator&   operator++() { next(); return *this; }
+        iterator    operator++(int) { iterator old = *this; next(); return old; }
+        bool        operator==(const iterator& other) const { return (end_ == other.end_ && (end_ || piece_.data() == other.piece_.data())); }
+        bool        operator!=(const iterator& other) const { return !(*this == other); }
+
+    private:
+        // Moves on to the next piece of the string.
+        void        next()
+        {
+            if (last_) { end_ = true; return; }
+            const size_t pos = (separator_.empty() ? std::string_view::npos : rest_.find(separator_));
+            if (pos == std::string_view::npos)
+            {
+                piece_ = rest_;
+                last_ = true;
+            }
+            else
+            {
+                piece_ = rest_.substr(0, pos);
+                rest_.remove_prefix(pos + separator_.size());
+            }
+        }
+
+        bool                end_ = true;    // Whether this iterator is past the last piece.
+        bool                last_ = false;  // Whether the current piece is the last one.
+        std::string_view    piece_;         // The current piece of the string.
+        std::string_view    rest_;          // The rest of the string, after the current piece.
+        std::string_view    separator_;     // The separator the string is being split by.
+    };
+
+                SplitView(std::string_view str, std::string_view separator) : separator_(separator), str_(str) { }  // Sets up the view; nothing is split yet.
+    iterator    begin() const { return iterator(str_, separator_); }  // Returns an iterator to the first piece of the string.
+    iterator    end() const { return iterator(); }  // Returns an iterator past the last piece of the string.
+
+private:
+    std::string_view    separator_; // The separator the string is being split by.
+    std::string_view    str_;       // The string being split.
+};
+
 void        collapse_list(std::vector<std::string>& vec);   // Collapses a string vector list, combining duplicates.
-std::string decode_compressed_string(std::string cb);   // Decodes a compressed string (e.g. 4cab2z becomes ccccabzz).
+            // As above, but returns each unique string (in order of first appearance) along with how many times it appears, without modifying the vector.
+std::vector<std::pair<std::string_view, size_t>>    collapse_list_counts(const std::vector<std::string>& vec);
+std::string decode_compressed_string(std::string_view cb); // Decodes a compressed string (e.g. 4cab2z becomes ccccabzz).
+std::string encode_compressed_string(std::string_view str); // Compresses a string which doesn't contain any digits (e.g. ccccabzz becomes 4cabzz).
 bool        find_and_replace(std::string& input, const std::string& to_find, const std::string& to_replace);    // Find and replace one string with another.
-std::string join_words(std::vector<std::string> vec, const std::string& spacer = " ");  // Takes a vector of strings and squashes them into one string.
+std::string join_words(const std::vector<std::string>& vec, std::string_view spacer = " ");  // Takes a vector of strings and squashes them into one string.
+void        join_words(StringSink out, const std::vector<std::string>& vec, std::string_view spacer = " ");  // As above, but appends to a string or buffer.
 std::string possessive_string(const std::string& str);  // Makes a string into a possessive noun (e.g. orc = orc's, platypus = platypus')
             // Replaces input with output, maintaining the capitalization of input (e.g. input="Meow" output="cat" result="Cat")
 std::string replace_keep_capitalization(const std::string& input, const std::string& output);
+            // Splits a string into a vector of views, which is cleared first but keeps its capacity.
+void        split_into(std::string_view str, std::vector<std::string_view>& out, std::string_view separator = " ");
+            // Splits a string into a vector of strings, reusing the vector's existing strings where possible.
+void        split_into(std::string_view str, std::vector<std::string>& out, std::string_view separator = " ");
+SplitView   split_view(std::string_view str, std::string_view separator = " ");  // Splits a string lazily, yielding each piece as a std::string_view.
 std::string str_repeat(const std::string& source, unsigned int repeats);    // Repeats a string a number of times.
-std::string str_tolower(std::string str);   // Converts a string to lower-case.
-std::string str_toupper(std::string str);   // Converts a string to upper-case.
-std::vector<std::string>    string_explode(std::string str, const std::string& separator = " ");    // String split/explode function.
+std::string str_tolower(std::string str);   // Converts a string to lower-case. Only ASCII letters are converted.
+void        str_tolower_in_place(std::string& str); // As above, but modifies the string in-place.
+std::string str_toupper(std::string str);   // Converts a string to upper-case. Only ASCII letters are converted.
+void        str_toupper_in_place(std::string& str); // As above, but modifies the string in-place.
+std::vector<std::string>    string_explode(std::string_view str, std::string_view separator = " ");  // String split/explode function.
 
 }   // namespace trailmix::text::manipulation
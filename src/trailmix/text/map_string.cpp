@@ -5,40 +5,50 @@
 // SPDX-License-Identifier: MIT
 
 #include <stdexcept>
-#include <vector>
 
-#include "trailmix/text/manipulation.hpp"
 #include "trailmix/text/map_string.hpp"
 
 using std::runtime_error;
 using std::string;
-using std::vector;
+using std::string_view;
 
 namespace trailmix::text::map_string {
 
 // Converts a map into a string.
 string map_to_string(const std::map<string, string>& the_map)
 {
+    if (the_map.empty()) return "";
+    size_t total = 0;
+    for (const auto& mde : the_map)
+        total += mde.first.size() + mde.second.size() + 2;
     string output;
-    if (the_map.size())
+    output.reserve(total);
+    for (const auto& mde : the_map)
     {
-        for (auto mde : the_map)
-            output += mde.first + ":" + mde.second + " ";
-        output.pop_back();
+        output += mde.first;
+        output += ':';
+        output += mde.second;
+        output += ' ';
     }
+    output.pop_back();
     return output;
 }
 
 // Converts a string to a map.
-void string_to_map(const string& str, std::map<string, string>& the_map)
+void string_to_map(string_view str, std::map<string, string>& the_map)
 {
     the_map.clear();
-    vector<string> md_exp = manipulation::string_explode(str, " ");
-    for (size_t i = 0; i < md_exp.size(); i++)
+    if (str.empty()) return;
+    size_t pos = 0;
+    while (true)
     {
-        vector<string> md_pair = manipulation::string_explode(md_exp.at(i), ":");
-        if (md_pair.size() != 2) throw runtime_error("Corrupt map in string conversion.");
-        the_map.insert(std::pair<string, string>(md_pair.at(0), md_pair.at(1)));
+        const size_t space = str.find(' ', pos);
+        const string_view md_exp = str.substr(pos, space == string_view::npos ? string_view::npos : space - pos);
+        const size_t colon = md_exp.find(':');
+        if (colon == string_view::npos || md_exp.find(':', colon + 1) != string_view::npos) throw runtime_error("Corrupt map in string conversion.");
+        the_map.emplace(md_exp.substr(0, colon), md_exp.substr(colon + 1));
+        if (space == string_view::npos) break;
+        pos = space + 1;
     }
 }
 
@@ -8,10 +8,11 @@
 
 #include <map>
 #include <string>
+#include <string_view>
 
 namespace trailmix::text::map_string {
 
 std::string map_to_string(const std::map<std::string, std::string>& the_map);   // Converts a map into a string.
-void        string_to_map(const std::string& str, std::map<std::string, std::string>& the_map);    // Converts a string to a map.
+void        string_to_map(std::string_view str, std::map<std::string, std::string>& the_map);  // Converts a string to a map.
 
 }   // namespace trailmix::text::map_string
@@ -0,0 +1,173 @@
+// text/replacement_set.cpp -- The ReplacementSet class performs many find-and-replace operations on a string at once, in a single pass, using an Aho-Corasick
+// automaton built from all the strings to be found.
+
+// SPDX-FileType: SOURCE
+// SPDX-FileCopyrightText: Copyright 2025 Raine Simmons <gc@gravecat.com>
+// SPDX-License-Identifier: MIT
+
+#include <stdexcept>
+
+#include "trailmix/text/replacement_set.hpp"
+
+using std::runtime_error;
+using std::string;
+using std::string_view;
+using std::vector;
+
+namespace trailmix::text::manipulation {
+
+namespace {
+
+constexpr uint32_t  NO_STATE = UINT32_MAX;  // Marks missing trie edges while the automaton is being built.
+
+}   // anonymous namespace
+
+// Creates a ReplacementSet from a list of strings to find and their replacements, and compiles it, ready to use.
+ReplacementSet::ReplacementSet(std::initializer_list<std::pair<string_view, string_view>> pairs)
+{
+    for (const auto& pair : pairs)
+        add(pair.first, pair.second);
+    compile();
+}
+
+// Adds a string to find, and its replacement. Requires compile() afterwards.
+void ReplacementSet::add(string_view to_find, string_view to_replace)
+{
+    if (to_find.empty()) return;
+    compiled_ = false;
+    for (auto& pattern : patterns_)
+    {
+        if (pattern.first == to_find)
+        {
+            pattern.second = to_replace;
+            return;
+        }
+    }
+    patterns_.emplace_back(to_find, to_replace);
+}
+
+// Performs all the replacements on a string in-place. Returns true if anything was replaced.
+bool ReplacementSet::apply(string& input) const
+{
+    string output;
+    if (!replace(input, output)) return false;
+    input.swap(output);
+    return true;
+}
+
+// Builds the automaton. This must be called after adding strings, before the ReplacementSet is used.
+void ReplacementSet::compile()
+{
+    // Sort the bytes into classes, so the transition table only needs a column for each byte that's actually used.
+    classes_.fill(0);
+    num_classes_ = 1;
+    for (const auto& pattern : patterns_)
+        for (unsigned char ch : pattern.first)
+            if (!classes_[ch]) classes_[ch] = static_cast<uint16_t>(num_classes_++);
+
+    // Build the trie of all the patterns.
+    transitions_.assign(num_classes_, NO_STATE);
+    depth_.assign(1, 0);
+    matches_.assign(1, -1);
+    for (size_t i = 0; i < patterns_.size(); i++)
+    {
+        uint32_t state = 0;
+        for (unsigned char ch : patterns_[i].first)
+        {
+            uint32_t& next = transitions_[state * num_classes_ + classes_[ch]];
+            if (next == NO_STATE)
+            {
+                next = static_cast<uint32_t>(depth_.size());
+                transitions_.resize(transitions_.size() + num_classes_, NO_STATE);
+                depth_.push_back(depth_[state] + 1);
+                matches_.push_back(-1);
+            }
+            state = transitions_[state * num_classes_ + classes_[ch]];
+        }
+        matches_[state] = static_cast<int32_t>(i);
+    }
+
+    // Work out the failure links breadth-first, filling in the missing trie edges to turn the trie into a complete state machine as we go.
+    vector<uint32_t> failure(depth_.size(), 0), queue;
+    queue.reserve(depth_.size());
+    for (size_t cls = 0; cls < num_classes_; cls++)
+    {
+        uint32_t& next = transitions_[cls];
+        if (next == NO_STATE) next = 0;
+        else queue.push_back(next);
+    }
+    for (size_t head = 0; head < queue.size(); head++)
+    {
+        const uint32_t state = queue[head];
+        if (matches_[state] < 0) matches_[state] = matches_[failure[state]];
+        for (size_t cls = 0; cls < num_classes_; cls++)
+        {
+            uint32_t& next = transitions_[state * num_classes_ + cls];
+            const uint32_t fallback = transitions_[failure[state] * num_classes_ + cls];
+            if (next == NO_STATE) next = fallback;
+            else
+            {
+                failure[next] = fallback;
+                queue.push_back(next);
+            }
+        }
+    }
+    compiled_ = true;
+}
+
+// Performs all the replacements on a string, writing the result into another string (which is cleared first). Returns true if anything was replaced.
+bool ReplacementSet::replace(string_view input, string& output) const
+{
+    if (!compiled_) throw runtime_error("ReplacementSet used without being compiled!");
+    output.clear();
+    if (patterns_.empty())
+    {
+        output.assign(input);
+        return false;
+    }
+
+    // Matches aren't acted on as soon as they're found, as a longer match might start earlier. Instead, the best match so far is kept until we're far enough
+    // along that nothing could start at or before it.
+    size_t copied = 0, match_start = string_view::npos, pos = 0;
+    int32_t match = -1;
+    uint32_t state = 0;
+    while(true)
+    {
+        if (pos < input.size())
+        {
+            state = transitions_[state * num_classes_ + classes_[static_cast<unsigned char>(input[pos])]];
+            pos++;
+            const int32_t found = matches_[state];
+            if (found >= 0)
+            {
+                const size_t found_start = pos - patterns_[found].first.size();
+                if (found_start <= match_start)
+                {
+                    match = found;
+                    match_start = found_start;
+                }
+            }
+            if (match < 0 || pos - depth_[state] <= match_start) continue;
+        }
+        else if (match < 0) break;
+
+        // Replace the match, then carry on from the end of it.
+        if (output.empty()) output.reserve(input.size() + input.size() / 4);
+        output.append(input, copied, match_start - copied);
+        output += patterns_[match].second;
+        copied = pos = match_start + patterns_[match].first.size();
+        match = -1;
+        match_start = string_view::npos;
+        state = 0;
+    }
+
+    if (!copied)
+    {
+        output.assign(input);
+        return false;
+    }
+    output.append(input, copied);
+    return true;
+}
+
+}   // namespace trailmix::text::manipulation
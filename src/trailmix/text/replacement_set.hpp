@@ -0,0 +1,45 @@
+// text/replacement_set.hpp -- The ReplacementSet class performs many find-and-replace operations on a string at once, in a single pass, using an Aho-Corasick
+// automaton built from all the strings to be found.
+
+// SPDX-FileType: SOURCE
+// SPDX-FileCopyrightText: Copyright 2025 Raine Simmons <gc@gravecat.com>
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace trailmix::text::manipulation {
+
+// Unlike calling find_and_replace() once for each pair, replacements are all found in the original string, so the text inserted by one replacement is never
+// matched by another. Where matches overlap, the one that starts first wins, and if two start at the same place, the longest wins.
+class ReplacementSet
+{
+public:
+                ReplacementSet() = default;     // Creates an empty ReplacementSet; add() and compile() must be called before it can be used.
+                // Creates a ReplacementSet from a list of strings to find and their replacements, and compiles it, ready to use.
+                ReplacementSet(std::initializer_list<std::pair<std::string_view, std::string_view>> pairs);
+    void        add(std::string_view to_find, std::string_view to_replace); // Adds a string to find, and its replacement. Requires compile() afterwards.
+    bool        apply(std::string& input) const;    // Performs all the replacements on a string in-place. Returns true if anything was replaced.
+    void        compile();  // Builds the automaton. This must be called after adding strings, before the ReplacementSet is used.
+                // Performs all the replacements on a string, writing the result into another string (which is cleared first). Returns true if anything was
+                // replaced.
+    bool        replace(std::string_view input, std::string& output) const;
+
+private:
+    std::array<uint16_t, 256>   classes_ = {};  // Maps each byte to its class; all bytes that don't appear in any pattern share class 0.
+    bool                    compiled_ = false;  // Whether the automaton is up to date with the list of patterns.
+    std::vector<uint32_t>   depth_;         // The length of the text matched by each state.
+    std::vector<int32_t>    matches_;       // The longest pattern that ends at each state, or -1 if there isn't one.
+    size_t                  num_classes_ = 1;   // The number of byte classes.
+    std::vector<std::pair<std::string, std::string>>    patterns_;  // The strings to be found, and their replacements.
+    std::vector<uint32_t>   transitions_;   // The state transition table, indexed by state * num_classes_ + byte class.
+};
+
+}   // namespace trailmix::text::manipulation
@@ -6,31 +6,35 @@
 
 #pragma once
 
+#include <cstdint>
 #include <set>
 #include <string>
-#include <vector>
+#include <string_view>
 
 #include "trailmix/text/conversion.hpp"
 #include "trailmix/text/manipulation.hpp"
 
 namespace trailmix::text::set_string {
 
-template<class T> static std::string set_to_string(std::set<T> the_set)
+template<class T> static std::string set_to_string(const std::set<T>& the_set)
 {
-    if (!the_set.size()) return "";
     std::string out_str;
-    for (auto num : the_set)
-        out_str += conversion::itoh(static_cast<long long>(num), 1) + " ";
-    if (out_str.size()) out_str = out_str.substr(0, out_str.size() - 1);    // Strip off the excess space at the end.
+    if (the_set.empty()) return out_str;
+    out_str.reserve(the_set.size() * 9);    // Enough for every entry to be a full eight-digit hex number.
+    for (const auto& num : the_set)
+    {
+        conversion::append_itoh(out_str, static_cast<uint32_t>(num), 1);
+        out_str += ' ';
+    }
+    out_str.pop_back();     // Strip off the excess space at the end.
     return out_str;
 }
 
-template<class T> static void string_to_set(std::string the_string, std::set<T> &the_set)
+template<class T> static void string_to_set(std::string_view the_string, std::set<T> &the_set)
 {
     the_set.clear();
-    if (!the_string.size()) return;
-    std::vector<std::string> split_string = manipulation::string_explode(the_string, " ");
-    for (auto num : split_string)
+    if (the_string.empty()) return;
+    for (auto num : manipulation::split_view(the_string, " "))
         the_set.insert(static_cast<T>(conversion::htoi(num)));
 }
 
@@ -0,0 +1,96 @@
+// text/string_pool.cpp -- StringPool stores each unique string it's given exactly once, and hands out InternedString handles to them. Handles from the
+// same pool compare equal only if their strings are equal, so comparing two of them is just comparing two pointers, and each carries a precomputed hash.
+
+// SPDX-FileType: SOURCE
+// SPDX-FileCopyrightText: Copyright 2025 Raine Simmons <gc@gravecat.com>
+// SPDX-License-Identifier: MIT
+
+#include <cstring>
+#include <stdexcept>
+
+#include "trailmix/text/hash.hpp"
+#include "trailmix/text/string_pool.hpp"
+
+using std::runtime_error;
+using std::string_view;
+
+namespace trailmix::text {
+
+// Finds a string in the pool without adding it, or returns std::nullopt if it's not there.
+std::optional<InternedString> StringPool::find(string_view str) const
+{
+    if (str.empty()) return InternedString();
+    const uint64_t hash = hash::fnv1a_64(str);
+    const Shard& shard = shards_[shard_index(hash)];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    const auto found = shard.index.find({hash, str});
+    if (found == shard.index.end()) return std::nullopt;
+    return InternedString(found->second);
+}
+
+// Adds a string to the pool if it's not already there, and returns a handle to it. This is thread-safe.
+InternedString StringPool::intern(string_view str)
+{
+    if (str.empty()) return InternedString();
+    if (str.size() > UINT32_MAX) throw runtime_error("String too long for StringPool!");
+    const uint64_t hash = hash::fnv1a_64(str);
+    Shard& shard = shards_[shard_index(hash)];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    const auto found = shard.index.find({hash, str});
+    if (found != shard.index.end()) return InternedString(found->second);
+
+    // Short strings are packed into the shard's current arena block, while any string too big to be worth packing gets a block of its own.
+    char* text;
+    const size_t needed = str.size() + 1;
+    if (needed > ARENA_BLOCK_SIZE / 4)
+    {
+        shard.blocks.emplace_back(new char[needed]);
+        text = shard.blocks.back().get();
+        shard.memory_used += needed;
+    }
+    else
+    {
+        if (!shard.current_block || shard.block_used + needed > ARENA_BLOCK_SIZE)
+        {
+            shard.blocks.emplace_back(new char[ARENA_BLOCK_SIZE]);
+            shard.current_block = shard.blocks.back().get();
+            shard.block_used = 0;
+            shard.memory_used += ARENA_BLOCK_SIZE;
+        }
+        text = shard.current_block + shard.block_used;
+        shard.block_used += needed;
+    }
+    std::memcpy(text, str.data(), str.size());
+    text[str.size()] = '\0';
+
+    shard.entries.push_back({text, static_cast<uint32_t>(str.size()), hash});
+    const InternedString::Entry* entry = &shard.entries.back();
+    shard.index.emplace(Key{hash, string_view(text, str.size())}, entry);
+    return InternedString(entry);
+}
+
+// Returns roughly how much memory the pool's arenas are using for strings.
+size_t StringPool::memory_used() const
+{
+    size_t total = 0;
+    for (const auto& shard : shards_)
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        total += shard.memory_used;
+    }
+    return total;
+}
+
+// Returns the number of unique strings in the pool.
+size_t StringPool::size() const
+{
+    size_t total = 0;
+    for (const auto& shard : shards_)
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        total += shard.entries.size();
+    }
+    return total;
+}
+
+}   // namespace trailmix::text
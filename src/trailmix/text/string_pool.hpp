@@ -0,0 +1,115 @@
+// text/string_pool.hpp -- StringPool stores each unique string it's given exactly once, and hands out InternedString handles to them. Handles from the
+// same pool compare equal only if their strings are equal, so comparing two of them is just comparing two pointers, and each carries a precomputed hash.
+
+// SPDX-FileType: SOURCE
+// SPDX-FileCopyrightText: Copyright 2025 Raine Simmons <gc@gravecat.com>
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "trailmix/text/hash.hpp"
+
+namespace trailmix::text {
+
+class StringPool;
+
+// A handle to a string stored in a StringPool. This is only valid for as long as the pool that created it, and should only be compared with handles from
+// the same pool. A default-constructed handle is the empty string.
+class InternedString
+{
+public:
+                InternedString() = default; // Creates a handle to the empty string.
+    const char* c_str() const { return entry_ ? entry_->text : ""; }    // Returns the string as a null-terminated C string.
+    bool        empty() const { return !entry_; }   // Checks if this is the empty string.
+    uint64_t    hash() const { return entry_ ? entry_->hash : EMPTY_HASH; } // Returns the string's hash, as with text::hash::fnv1a_64().
+    size_t      size() const { return entry_ ? entry_->size : 0; }  // Returns the length of the string.
+    std::string_view    view() const { return std::string_view(c_str(), size()); }  // Returns a view of the string.
+                operator std::string_view() const { return view(); }            // As above, but as an implicit conversion.
+    bool        operator==(const InternedString& other) const { return entry_ == other.entry_; }
+    bool        operator!=(const InternedString& other) const { return entry_ != other.entry_; }
+
+private:
+    static constexpr uint64_t EMPTY_HASH = text::hash::FNV1A_64_OFFSET;  // The FNV-1a hash of an empty string.
+
+    // A unique string stored in a pool.
+    struct Entry
+    {
+        const char* text;   // The string's text, null-terminated, in the pool's arena.
+        uint32_t    size;   // The length of the string.
+        uint64_t    hash;   // The string's hash.
+    };
+
+                InternedString(const Entry* entry) : entry_(entry) { }  // Used by StringPool to create handles.
+
+    const Entry*    entry_ = nullptr;   // The pool's entry for this string, or nullptr for the empty string.
+
+    friend class StringPool;
+};
+
+class StringPool
+{
+public:
+                StringPool() = default;     // Creates an empty pool.
+                StringPool(const StringPool&) = delete;             // Handles point into the pool, so it can't be copied.
+    StringPool& operator=(const StringPool&) = delete;              // As above.
+    std::optional<InternedString>   find(std::string_view str) const;   // Finds a string in the pool without adding it, or returns std::nullopt if it's not there.
+    InternedString  intern(std::string_view str);   // Adds a string to the pool if it's not already there, and returns a handle to it. This is thread-safe.
+    size_t      memory_used() const;        // Returns roughly how much memory the pool's arenas are using for strings.
+    size_t      size() const;               // Returns the number of unique strings in the pool.
+
+private:
+    static constexpr size_t ARENA_BLOCK_SIZE = 64 * 1024;   // The size of each block of string storage in the arena.
+    static constexpr size_t SHARD_COUNT = 16;   // The number of separately-locked shards in the pool.
+
+    // The key used to look up strings in a shard, which carries its hash so it doesn't need to be recalculated.
+    struct Key
+    {
+        uint64_t            hash;   // The string's hash.
+        std::string_view    text;   // The string itself.
+        bool        operator==(const Key& other) const { return hash == other.hash && text == other.text; }
+    };
+
+    // Uses a key's precomputed hash.
+    struct KeyHash
+    {
+        size_t      operator()(const Key& key) const { return static_cast<size_t>(key.hash); }
+    };
+
+    // One shard of the pool. Each has its own lock, so threads interning different strings rarely wait on each other.
+    struct Shard
+    {
+        size_t                          block_used = 0; // How much of the current arena block is in use.
+        std::vector<std::unique_ptr<char[]>>    blocks; // The arena blocks, which hold the text of every string in this shard.
+        char*                           current_block = nullptr;    // The arena block that short strings are currently being added to.
+        std::deque<InternedString::Entry>   entries;    // The entries for each string, which never move once added.
+        std::unordered_map<Key, const InternedString::Entry*, KeyHash>  index; // Looks up entries by their strings.
+        size_t                          memory_used = 0;    // How much memory the arena blocks are using.
+        mutable std::mutex              mutex;      // Locks this shard.
+    };
+
+    static size_t   shard_index(uint64_t hash) { return static_cast<size_t>(hash >> 60); }  // Picks the shard for a given hash, using its top four bits.
+
+    Shard       shards_[SHARD_COUNT];   // The shards of the pool.
+};
+
+}   // namespace trailmix::text
+
+namespace std {
+
+template <> struct hash<trailmix::text::InternedString>
+{
+    std::size_t operator()(const trailmix::text::InternedString& str) const noexcept { return static_cast<std::size_t>(str.hash()); }
+};
+
+}   // namespace std
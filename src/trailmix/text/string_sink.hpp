@@ -0,0 +1,80 @@
+// text/string_sink.hpp -- StringSink is a lightweight handle for appending text to either a std::string or a fixed-capacity FixedString, so that formatting
+// functions can build up text into an existing buffer rather than returning new strings. A FixedString lives on the stack and never allocates at all.
+
+// SPDX-FileType: SOURCE
+// SPDX-FileCopyrightText: Copyright 2025 Raine Simmons <gc@gravecat.com>
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace trailmix::text {
+
+// The non-templated part of FixedString, so that functions can work with fixed strings of any capacity.
+class FixedStringBase
+{
+public:
+                FixedStringBase(const FixedStringBase&) = delete;               // The buffer belongs to the derived FixedString, so this can't be copied.
+    FixedStringBase& operator=(const FixedStringBase&) = delete;                // As above.
+    void        append(std::string_view str)    // Appends text to the end of the string. Throws if the string's capacity would be exceeded.
+    { make_room(str.size()); std::memcpy(buffer_ + size_, str.data(), str.size()); size_ += str.size(); }
+    void        append(size_t count, char ch)   // Appends a number of copies of a character to the end of the string.
+    { make_room(count); std::memset(buffer_ + size_, ch, count); size_ += count; }
+    const char* c_str() const { buffer_[size_] = '\0'; return buffer_; }        // Returns the string as a null-terminated C string.
+    size_t      capacity() const { return capacity_; }  // Returns the maximum length of this string.
+    void        clear() { size_ = 0; }                  // Clears the string, without changing its capacity.
+    const char* data() const { return buffer_; }        // Returns the string's data; this is not null-terminated.
+    bool        empty() const { return !size_; }        // Checks if the string is empty.
+    size_t      size() const { return size_; }          // Returns the current length of the string.
+    std::string_view    view() const { return std::string_view(buffer_, size_); }   // Returns a view of the string.
+                operator std::string_view() const { return view(); }            // As above, but as an implicit conversion.
+
+protected:
+                FixedStringBase(char* buffer, size_t capacity) : buffer_(buffer), capacity_(capacity), size_(0) { } // Used by FixedString to set up its buffer.
+
+private:
+    void        make_room(size_t len) const // Throws if there isn't enough space left in the string for additional text.
+    { if (len > capacity_ - size_) throw std::runtime_error("FixedString capacity exceeded (" + std::to_string(capacity_) + ")"); }
+
+    char*       buffer_;    // The string's buffer, which is owned by the derived FixedString and has room for a null terminator after the capacity.
+    size_t      capacity_;  // The maximum length of the string.
+    size_t      size_;      // The current length of the string.
+};
+
+// A string with a fixed maximum length, stored entirely within the object itself.
+template<size_t N> class FixedString : public FixedStringBase
+{
+public:
+                FixedString() : FixedStringBase(storage_, N) { }   // Creates an empty string.
+
+private:
+    char        storage_[N + 1];    // The string's characters, with room for a null terminator.
+};
+
+// A handle for appending text to either a std::string or a FixedString. This is meant to be passed by value, and converts implicitly from either type.
+class StringSink
+{
+public:
+                StringSink(std::string& str) : fixed_(nullptr), str_(&str) { }  // Appends to a std::string.
+                StringSink(FixedStringBase& fixed) : fixed_(&fixed), str_(nullptr) { }  // Appends to a FixedString.
+    StringSink& append(std::string_view str)    // Appends text to the sink.
+    { if (str_) str_->append(str); else fixed_->append(str); return *this; }
+    StringSink& append(size_t count, char ch)   // Appends a number of copies of a character to the sink.
+    { if (str_) str_->append(count, ch); else fixed_->append(count, ch); return *this; }
+    StringSink& operator+=(std::string_view str) { return append(str); }    // Appends text to the sink.
+    StringSink& operator+=(char ch) { return append(1, ch); }   // Appends a single character to the sink.
+    void        reserve(size_t extra)       // Makes room for a given amount of additional text, if the sink is a std::string.
+    { if (str_ && str_->capacity() < str_->size() + extra) str_->reserve(str_->size() + extra); }
+    size_t      size() const { return (str_ ? str_->size() : fixed_->size()); }    // Returns the current length of the text in the sink.
+
+private:
+    FixedStringBase*    fixed_; // The fixed string being appended to, if any.
+    std::string*        str_;   // The std::string being appended to, if any.
+};
+
+}   // namespace trailmix::text
@@ -0,0 +1,158 @@
+// text/text_template.cpp -- The TextTemplate class parses a string with conditional tags (as used by process_conditional_tags()) and substitutions once, so
+// that it can be rendered over and over with different tags and values in a single pass each time.
+
+// SPDX-FileType: SOURCE
+// SPDX-FileCopyrightText: Copyright 2025 Raine Simmons <gc@gravecat.com>
+// SPDX-License-Identifier: MIT
+
+#include <stdexcept>
+
+#include "trailmix/text/text_template.hpp"
+
+using std::runtime_error;
+using std::string;
+using std::string_view;
+using std::vector;
+
+namespace trailmix::text::formatting {
+
+// Parses a template string.
+TextTemplate::TextTemplate(string str) { assign(std::move(str)); }
+
+// Replaces this template with a newly-parsed string. All tags and values are cleared.
+void TextTemplate::assign(string str)
+{
+    source_ = std::move(str);
+    names_.clear();
+    segments_.clear();
+
+    vector<size_t> open;    // The conditional tags which haven't been closed yet.
+    size_t pos = 0, literal_start = 0;
+    auto add_segment = [this, &literal_start](SegmentType type, uint16_t slot, size_t start, size_t end) {
+        if (start > literal_start) segments_.push_back({SegmentType::LITERAL, 0, static_cast<uint32_t>(literal_start),
+            static_cast<uint32_t>(start - literal_start), 0});
+        segments_.push_back({type, slot, static_cast<uint32_t>(start), static_cast<uint32_t>(end - start), 0});
+        literal_start = end;
+    };
+
+    while (pos < source_.size())
+    {
+        if (source_[pos] == '[')
+        {
+            const size_t name_end = source_.find_first_of("[]:", pos + 1);
+            if (name_end != string::npos && name_end > pos + 1 && source_[name_end] != '[')
+            {
+                const uint16_t name_slot = slot(string_view(source_).substr(pos + 1, name_end - pos - 1));
+                if (source_[name_end] == ':')
+                {
+                    open.push_back(segments_.size() + (pos > literal_start ? 1 : 0));
+                    add_segment(SegmentType::CONDITIONAL, name_slot, pos, name_end + 1);
+                }
+                else add_segment(SegmentType::SUBSTITUTION, name_slot, pos, name_end + 1);
+                pos = name_end + 1;
+                continue;
+            }
+        }
+        else if (source_[pos] == ']' && open.size())
+        {
+            const size_t opener = open.back();
+            open.pop_back();
+            add_segment(SegmentType::CLOSE, segments_[opener].slot, pos, pos + 1);
+            segments_[opener].end = static_cast<uint32_t>(segments_.size());
+            pos++;
+            continue;
+        }
+        pos++;
+    }
+    if (source_.size() > literal_start) segments_.push_back({SegmentType::LITERAL, 0, static_cast<uint32_t>(literal_start),
+        static_cast<uint32_t>(source_.size() - literal_start), 0});
+    // Any conditional tags that were never closed are left as they are, rather than hiding the rest of the text.
+    for (auto opener : open)
+        segments_[opener].type = SegmentType::LITERAL;
+
+    tags_.assign(names_.size(), -1);
+    has_value_.assign(names_.size(), 0);
+    values_.assign(names_.size(), string());
+}
+
+// Clears the states of all tags, and the values of all substitutions.
+void TextTemplate::clear()
+{
+    tags_.assign(names_.size(), -1);
+    has_value_.assign(names_.size(), 0);
+}
+
+// Finds the slot for a tag or substitution name, or returns -1 if it's not in this template.
+int TextTemplate::find_slot(string_view name) const
+{
+    for (size_t i = 0; i < names_.size(); i++)
+        if (names_[i] == name) return static_cast<int>(i);
+    return -1;
+}
+
+// Renders the template with the current tags and values.
+string TextTemplate::render() const
+{
+    string output;
+    render(output);
+    return output;
+}
+
+// As above, but appends the result to an existing string.
+void TextTemplate::render(string& out) const
+{
+    out.reserve(out.size() + source_.size());
+    size_t i = 0;
+    while (i < segments_.size())
+    {
+        const Segment& segment = segments_[i];
+        switch(segment.type)
+        {
+            case SegmentType::LITERAL: out.append(source_, segment.offset, segment.length); break;
+            case SegmentType::SUBSTITUTION:
+                if (has_value_[segment.slot]) out += values_[segment.slot];
+                else out.append(source_, segment.offset, segment.length);
+                break;
+            case SegmentType::CONDITIONAL:
+                if (!tags_[segment.slot])
+                {
+                    i = segment.end;
+                    continue;
+                }
+                if (tags_[segment.slot] < 0) out.append(source_, segment.offset, segment.length);
+                break;
+            case SegmentType::CLOSE:
+                if (tags_[segment.slot] < 0) out += ']';
+                break;
+        }
+        i++;
+    }
+}
+
+// Sets whether a conditional tag's text is included or removed.
+void TextTemplate::set_tag(string_view tag, bool active)
+{
+    const int found = find_slot(tag);
+    if (found >= 0) tags_[found] = (active ? 1 : 0);
+}
+
+// Sets the value of a substitution.
+void TextTemplate::set_value(string_view name, string_view value)
+{
+    const int found = find_slot(name);
+    if (found < 0) return;
+    values_[found].assign(value);
+    has_value_[found] = 1;
+}
+
+// Finds the slot for a tag or substitution name, adding a new one if needed.
+uint16_t TextTemplate::slot(string_view name)
+{
+    const int found = find_slot(name);
+    if (found >= 0) return static_cast<uint16_t>(found);
+    if (names_.size() > UINT16_MAX) throw runtime_error("Too many unique names in TextTemplate!");
+    names_.emplace_back(name);
+    return static_cast<uint16_t>(names_.size() - 1);
+}
+
+}   // namespace trailmix::text::formatting
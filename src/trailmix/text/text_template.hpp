@@ -0,0 +1,54 @@
+// text/text_template.hpp -- The TextTemplate class parses a string with conditional tags (as used by process_conditional_tags()) and substitutions once, so
+// that it can be rendered over and over with different tags and values in a single pass each time.
+// Conditional tags are in the form [tag_name:conditional text here], and substitutions are in the form [name]. Conditional text can contain further
+// conditional tags and substitutions. Any tag or substitution which hasn't been given a state or value is left in the rendered text exactly as it was written.
+
+// SPDX-FileType: SOURCE
+// SPDX-FileCopyrightText: Copyright 2025 Raine Simmons <gc@gravecat.com>
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace trailmix::text::formatting {
+
+class TextTemplate
+{
+public:
+                TextTemplate() = default;       // Creates an empty TextTemplate.
+                TextTemplate(std::string str);  // Parses a template string.
+    void        assign(std::string str);        // Replaces this template with a newly-parsed string. All tags and values are cleared.
+    void        clear();                        // Clears the states of all tags, and the values of all substitutions.
+    std::string render() const;                 // Renders the template with the current tags and values.
+    void        render(std::string& out) const; // As above, but appends the result to an existing string.
+    void        set_tag(std::string_view tag, bool active); // Sets whether a conditional tag's text is included or removed.
+    void        set_value(std::string_view name, std::string_view value);   // Sets the value of a substitution.
+
+private:
+    enum class SegmentType : uint8_t { LITERAL, CONDITIONAL, CLOSE, SUBSTITUTION };
+
+    // A single segment of the parsed template.
+    struct Segment
+    {
+        SegmentType type;
+        uint16_t    slot;   // The name used by a conditional tag, closing bracket or substitution.
+        uint32_t    offset, length; // The segment's original text in the source string.
+        uint32_t    end;    // For conditional tags, the index of the segment after the tag's closing bracket.
+    };
+
+    int         find_slot(std::string_view name) const; // Finds the slot for a tag or substitution name, or returns -1 if it's not in this template.
+    uint16_t    slot(std::string_view name);    // Finds the slot for a tag or substitution name, adding a new one if needed.
+
+    std::vector<uint8_t>        has_value_; // Whether each slot has a substitution value.
+    std::vector<std::string>    names_;     // The tag and substitution names used in this template, indexed by slot.
+    std::vector<Segment>        segments_;  // The parsed segments of the template.
+    std::string                 source_;    // The original template string.
+    std::vector<int8_t>         tags_;      // The state of each slot's conditional tag: 1 for active, 0 for inactive, or -1 if not set.
+    std::vector<std::string>    values_;    // The substitution value for each slot.
+};
+
+}   // namespace trailmix::text::formatting
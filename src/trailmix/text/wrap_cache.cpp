@@ -0,0 +1,99 @@
+// text/wrap_cache.cpp -- The WrapCache class keeps the results of recent ansi_string_explode() calls, so that text which is re-wrapped over and over (such as the
+// lines of a scrolling message log) only has to be wrapped once for each line length.
+
+// SPDX-FileType: SOURCE
+// SPDX-FileCopyrightText: Copyright 2025 Raine Simmons <gc@gravecat.com>
+// SPDX-License-Identifier: MIT
+
+#include <functional>
+#include <iterator>
+#include <string_view>
+
+#include "trailmix/internal/hash_combine.hpp"
+#include "trailmix/text/ansiutils.hpp"
+#include "trailmix/text/wrap_cache.hpp"
+
+using std::string;
+using std::vector;
+
+namespace trailmix::text::ansi {
+
+// Creates a cache holding up to the specified number of wrapped strings.
+WrapCache::WrapCache(size_t capacity) : capacity_(capacity ? capacity : 1) { }
+
+// Erases everything in the cache.
+void WrapCache::clear()
+{
+    entries_.clear();
+    index_.clear();
+}
+
+// Erases the least recently used entry in the cache.
+void WrapCache::evict()
+{
+    index_.erase(entries_.back().key);
+    entries_.pop_back();
+}
+
+// Erases all cached results for a specified line length, for example when a window has been resized.
+void WrapCache::invalidate(unsigned int line_len)
+{
+    for (auto it = entries_.begin(); it != entries_.end(); )
+    {
+        if (it->line_len == line_len)
+        {
+            index_.erase(it->key);
+            it = entries_.erase(it);
+        }
+        else ++it;
+    }
+}
+
+// Changes the maximum number of wrapped strings this cache can hold, erasing the oldest if needed.
+void WrapCache::set_capacity(size_t capacity)
+{
+    capacity_ = (capacity ? capacity : 1);
+    while (entries_.size() > capacity_)
+        evict();
+}
+
+// Returns the same result as ansi_string_explode(), from the cache if possible. The returned vector is only valid until the next call to wrap().
+const vector<string>& WrapCache::wrap(const string& str, unsigned int line_len)
+{
+    size_t key = std::hash<std::string_view>{}(str);
+    internal::hash_combine(key, line_len);
+
+    auto found = index_.find(key);
+    if (found != index_.end())
+    {
+        Entry& entry = *found->second;
+        entries_.splice(entries_.begin(), entries_, found->second);
+        if (entry.line_len == line_len && entry.source == str)
+        {
+            hits_++;
+            return entry.lines;
+        }
+    }
+    else
+    {
+        // Reuse the least recently used entry if the cache is full, so its strings' memory can be recycled.
+        if (entries_.size() >= capacity_)
+        {
+            index_.erase(entries_.back().key);
+            entries_.splice(entries_.begin(), entries_, std::prev(entries_.end()));
+        }
+        else entries_.emplace_front();
+        entries_.front().key = key;
+        index_[key] = entries_.begin();
+    }
+
+    // Either this is a new entry, or a different string with the same key, which is simply replaced.
+    misses_++;
+    Entry& entry = entries_.front();
+    entry.line_len = line_len;
+    entry.source.assign(str);
+    ansi_string_explode(str, line_len, entry.lines);
+    return entry.lines;
+}
+
+}   // namespace trailmix::text::ansi
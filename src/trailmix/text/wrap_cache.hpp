@@ -0,0 +1,51 @@
+// text/wrap_cache.hpp -- The WrapCache class keeps the results of recent ansi_string_explode() calls, so that text which is re-wrapped over and over (such as the
+// lines of a scrolling message log) only has to be wrapped once for each line length.
+
+// SPDX-FileType: SOURCE
+// SPDX-FileCopyrightText: Copyright 2025 Raine Simmons <gc@gravecat.com>
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace trailmix::text::ansi {
+
+class WrapCache
+{
+public:
+                WrapCache(size_t capacity = 1024);  // Creates a cache holding up to the specified number of wrapped strings.
+    size_t      capacity() const { return capacity_; }  // Returns the maximum number of wrapped strings this cache can hold.
+    void        clear();                        // Erases everything in the cache.
+    uint64_t    hits() const { return hits_; }  // Returns the number of times wrap() has found its result in the cache.
+    void        invalidate(unsigned int line_len);  // Erases all cached results for a specified line length, for example when a window has been resized.
+    uint64_t    misses() const { return misses_; }  // Returns the number of times wrap() has had to wrap a string itself.
+    void        set_capacity(size_t capacity);  // Changes the maximum number of wrapped strings this cache can hold, erasing the oldest if needed.
+    size_t      size() const { return entries_.size(); }    // Returns the number of wrapped strings currently in the cache.
+                // Returns the same result as ansi_string_explode(), from the cache if possible. The returned vector is only valid until the next call to wrap().
+    const std::vector<std::string>& wrap(const std::string& str, unsigned int line_len);
+
+private:
+    struct Entry
+    {
+        size_t          key;        // The combined hash of the source string and line length.
+        unsigned int    line_len;   // The line length the string was wrapped to.
+        std::vector<std::string>    lines;  // The wrapped lines.
+        std::string     source;     // The original string.
+    };
+
+    void        evict();    // Erases the least recently used entry in the cache.
+
+    size_t              capacity_;  // The maximum number of wrapped strings this cache can hold.
+    std::list<Entry>    entries_;   // The cached entries, with the most recently used at the front.
+    uint64_t            hits_ = 0;  // The number of times wrap() has found its result in the cache.
+    std::unordered_map<size_t, std::list<Entry>::iterator>  index_; // The cached entries, indexed by their key.
+    uint64_t            misses_ = 0;    // The number of times wrap() has had to wrap a string itself.
+};
+
+}   // namespace trailmix::text::ansi